@@ -94,6 +94,9 @@ void AssociationHelper::associate(uint16_t coordPANId, AddrMode addrMode, IEEE80
     params.channelOffset = this->dsmeAdaptionLayer.getMAC_PIB().macChannelOffset;
     params.hoppingSequenceId = 1;
     params.hoppingSequenceRequest = true;
+    /* request a first GTS to the coordinator to skip the GTS negotiation, only possible with the non-standard command extension */
+    params.dsmeAssociation = this->dsmeAdaptionLayer.getMAC_PIB().macAssociationGTSAllocation;
+    params.direction = Direction::TX;
 
     // TODO start timer for macMaxFrameTotalWaitTime, report NO_DATA on timeout
     this->dsmeAdaptionLayer.getMLME_SAP().getASSOCIATE().request(params);
@@ -121,6 +124,18 @@ void AssociationHelper::handleASSOCIATION_indication(mlme_sap::ASSOCIATE_indicat
         response_params.hoppingSequence = dsmeAdaptionLayer.getMAC_PIB().macHoppingSequenceList;
     }
 
+    response_params.direction = params.direction;
+    if(params.dsmeAssociation && dsmeAdaptionLayer.getMAC_PIB().macChannelDiversityMode == Channel_Diversity_Mode::CHANNEL_ADAPTATION) {
+        GTS gts = this->dsmeAdaptionLayer.getGTSHelper().getFreeGTSForAssociation();
+        if(gts != GTS::UNDEFINED) {
+            LOG_INFO("Allocating GTS " << gts.slotID << " " << gts.superframeID << " " << (uint16_t)gts.channel << " with the association.");
+            response_params.dsmeAssociation = true;
+            response_params.superframeId = gts.superframeID;
+            response_params.slotId = gts.slotID;
+            response_params.channelIndex = gts.channel;
+        }
+    }
+
     // TODO update list of associated devices
 
     this->dsmeAdaptionLayer.getMLME_SAP().getASSOCIATE().response(response_params);
@@ -135,8 +135,8 @@ void DSMEAdaptionLayer::setConfirmCallback(confirmCallback_t callback_confirm) {
     return;
 }
 
-void DSMEAdaptionLayer::sendMessage(IDSMEMessage* msg) {
-    this->messageHelper.sendMessage(msg);
+void DSMEAdaptionLayer::sendMessage(IDSMEMessage* msg, bool criticalEvent) {
+    this->messageHelper.sendMessage(msg, criticalEvent);
 }
 
 void DSMEAdaptionLayer::startAssociation() {
@@ -97,7 +97,10 @@ public:
     void setIndicationCallback(indicationCallback_t);
     void setConfirmCallback(confirmCallback_t);
 
-    void sendMessage(IDSMEMessage* msg);
+    /**
+     * Sends a message to its destination, critical event messages are prioritized if macPriorityChannelAccess is set
+     */
+    void sendMessage(IDSMEMessage* msg, bool criticalEvent = false);
     void startAssociation();
 
     uint16_t getRandom();
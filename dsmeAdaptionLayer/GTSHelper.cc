@@ -91,20 +91,40 @@ void GTSHelper::indicateReceivedMessage(uint16_t address) {
 }
 
 void GTSHelper::handleStartOfCFP() {
-    if(this->dsmeAdaptionLayer.getDSME().getCurrentSuperframe() == 0) {
-        this->gtsScheduling->multisuperframeEvent();
-    }
+    bool multisuperframeStarted = (this->dsmeAdaptionLayer.getDSME().getStartOfCFPSuperframe() == 0);
+    this->gtsScheduling->updateFromMAC();
 
     /* Check allocation at random superframe in multi-superframe */
     uint8_t num_superframes = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
     uint8_t random_frame = this->dsmeAdaptionLayer.getDSME().getPlatform().getRandom() % num_superframes;
+
+#ifdef DSME_THREADED_UPPER_HALF
+    /* '-> the scheduling state is only accessed by the upper half, so the slot engine is not blocked while it is computed */
+    uint8_t numGTSlotsLatterSuperframes = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(1);
+    this->dsmeAdaptionLayer.getDSME().getPlatform().unlockLowerHalf();
+#endif
+    if(multisuperframeStarted) {
+        this->gtsScheduling->multisuperframeEvent();
+    }
+    GTSSchedulingDecision decision = this->gtsScheduling->getNextSchedulingAction();
+#ifdef DSME_THREADED_UPPER_HALF
+    this->dsmeAdaptionLayer.getDSME().getPlatform().lockLowerHalf();
+
+    if(numGTSlotsLatterSuperframes != this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(1)) {
+        /* '-> the CAP reduction was switched in the meantime, the next start of CFP decides again */
+        LOG_INFO("Scheduling decision for previous slot structure discarded");
+        return;
+    }
+#endif
+
     //if(this->dsmeAdaptionLayer.getDSME().getCurrentSuperframe() == random_frame) {
-    performSchedulingAction(this->gtsScheduling->getNextSchedulingAction());
+    performSchedulingAction(decision);
     //}
     return;
 }
 
 void GTSHelper::checkAllocationForPacket(uint16_t address) {
+    this->gtsScheduling->updateFromMAC();
     performSchedulingAction(this->gtsScheduling->getNextSchedulingAction(address));
     return;
 }
@@ -355,8 +375,8 @@ void GTSHelper::handleDSME_GTS_confirm(mlme_sap::DSME_GTS_confirm_parameters& pa
     if(params.managementType == ManagementType::ALLOCATION) {
         gtsConfirmPending = false;
         LOG_DEBUG("gtsConfirmPending = false");
-        if(params.status == GTSStatus::SUCCESS) {
-            this->dsmeAdaptionLayer.getMessageHelper().sendRetryBuffer();
+        if(params.status == GTSStatus::SUCCESS && params.direction == Direction::TX) {
+            this->dsmeAdaptionLayer.getMessageHelper().sendRetryBuffer(params.deviceAddress);
         }
         if(params.status != GTSStatus::TRANSACTION_OVERFLOW) {
             performSchedulingAction(this->gtsScheduling->getNextSchedulingAction());
@@ -365,6 +385,17 @@ void GTSHelper::handleDSME_GTS_confirm(mlme_sap::DSME_GTS_confirm_parameters& pa
     return;
 }
 
+GTS GTSHelper::getFreeGTSForAssociation() {
+    if(gtsConfirmPending) {
+        /* '-> the pending negotiation might select the same slot */
+        return GTS::UNDEFINED;
+    }
+
+    uint16_t superframeId = this->dsmeAdaptionLayer.getRandom() % this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
+    uint8_t slotId = this->dsmeAdaptionLayer.getRandom() % this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(superframeId);
+    return getNextFreeGTS(superframeId, slotId);
+}
+
 GTS GTSHelper::getNextFreeGTS(uint16_t initialSuperframeID, uint8_t initialSlotID, const DSMESABSpecification* sabSpec) {
     DSMEAllocationCounterTable& macDSMEACT = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT;
     DSMESlotAllocationBitmap& macDSMESAB = this->dsmeAdaptionLayer.getMAC_PIB().macDSMESAB;
@@ -77,6 +77,13 @@ public:
 
     void handleStartOfCFP();
 
+    /**
+     * Selects a free GTS that is allocated together with the association of a new device (fast join)
+     *
+     * @return GTS::UNDEFINED if no GTS is free or a GTS negotiation is pending
+     */
+    GTS getFreeGTSForAssociation();
+
 private:
     /* MLME handlers */
 
@@ -57,7 +57,8 @@ MessageHelper::MessageHelper(DSMEAdaptionLayer& dsmeAdaptionLayer)
     : dsmeAdaptionLayer(dsmeAdaptionLayer),
 
       scanOrSyncInProgress(false),
-      associationInProgress(false) {
+      associationInProgress(false),
+      retryOverflowPolicy(RetryOverflowPolicy::DROP_OLDEST) {
 }
 
 void MessageHelper::initialize() {
@@ -76,6 +77,11 @@ void MessageHelper::setConfirmCallback(confirmCallback_t callback_confirm) {
     return;
 }
 
+void MessageHelper::setRetryOverflowPolicy(RetryOverflowPolicy policy) {
+    this->retryOverflowPolicy = policy;
+    return;
+}
+
 void MessageHelper::receiveIndication(IDSMEMessage* msg) {
     if(this->callback_indication) {
         callback_indication(msg);
@@ -96,25 +102,39 @@ void MessageHelper::startAssociation() {
     }
 }
 
-void MessageHelper::sendRetryBuffer() {
-    if(!this->retryBuffer.isEmpty()) {
-        DSMEAdaptionLayerBufferEntry* oldestEntry = this->retryBuffer.front();
-        do {
-            IDSMEMessage* currentMessage = this->retryBuffer.front()->message;
-            DSME_ASSERT(!currentMessage->getCurrentlySending());
+void MessageHelper::sendRetryBuffer(uint16_t deviceAddress) {
+    IEEE802154MacAddress destination(deviceAddress);
+    NeighborQueue<MAX_NEIGHBORS, UPPER_LAYER_QUEUE_SIZE>::iterator it = this->retryBuffer.findByAddress(destination);
+    if(it == this->retryBuffer.end()) {
+        return;
+    }
 
-            this->retryBuffer.pop();
-            sendMessageDown(currentMessage, false);
-        } while((!this->retryBuffer.isEmpty()) && this->retryBuffer.front() != oldestEntry);
+    /* messages that fail again are queued at the back, so only send the ones currently waiting */
+    queue_size_t numMessages = this->retryBuffer.getPacketsInQueue(it);
+    for(queue_size_t i = 0; i < numMessages; i++) {
+        it = this->retryBuffer.findByAddress(destination);
+        if(it == this->retryBuffer.end() || this->retryBuffer.isQueueEmpty(it)) {
+            break;
+        }
+
+        IDSMEMessage* currentMessage = this->retryBuffer.popFront(it);
+        DSME_ASSERT(!currentMessage->getCurrentlySending());
+        /* '-> a critical event message keeps its original deadline */
+        sendMessageDown(currentMessage, false, currentMessage->getHeader().isCriticalEvent());
+    }
+
+    it = this->retryBuffer.findByAddress(destination);
+    if(it != this->retryBuffer.end() && this->retryBuffer.isQueueEmpty(it)) {
+        this->retryBuffer.eraseNeighbor(it);
     }
 }
 
-void MessageHelper::sendMessage(IDSMEMessage* msg) {
+void MessageHelper::sendMessage(IDSMEMessage* msg, bool criticalEvent) {
     LOG_INFO("Sending DATA message");
-    sendMessageDown(msg, true);
+    sendMessageDown(msg, true, criticalEvent);
 }
 
-void MessageHelper::sendMessageDown(IDSMEMessage* msg, bool newMessage) {
+void MessageHelper::sendMessageDown(IDSMEMessage* msg, bool newMessage, bool criticalEvent) {
     if(msg == nullptr) {
         /* '-> Error! */
         DSME_ASSERT(false);
@@ -175,6 +195,7 @@ void MessageHelper::sendMessageDown(IDSMEMessage* msg, bool newMessage) {
         params.seqNumSuppressed = false;
 
         params.sendMultipurpose = false;
+        params.criticalEventMessage = criticalEvent;
 
         if(params.gtsTx) {
             uint16_t srcAddr = this->dsmeAdaptionLayer.getMAC_PIB().macShortAddress;
@@ -214,35 +235,58 @@ void MessageHelper::handleDataIndication(mcps_sap::DATA_indication_parameters& p
 }
 
 bool MessageHelper::queueMessageIfPossible(IDSMEMessage* msg) {
-    if(this->retryBuffer.isFull()) {
-        DSME_ASSERT(!this->retryBuffer.isEmpty());
-
-        DSMEAdaptionLayerBufferEntry* oldestEntry = this->retryBuffer.front();
-        if(oldestEntry->message == msg) {
-            this->retryBuffer.pop();
-            DSME_ASSERT(!this->retryBuffer.isEmpty());
-            this->retryBuffer.freeElement()->message = msg;
-            this->retryBuffer.freeElement()->initialSymbolCounter = this->dsmeAdaptionLayer.getDSME().getPlatform().getSymbolCounter();
-            this->retryBuffer.pushFreeElement();
-            return true;
+    typedef NeighborQueue<MAX_NEIGHBORS, UPPER_LAYER_QUEUE_SIZE>::iterator retry_iterator;
+
+    IEEE802154MacAddress destination = msg->getHeader().getDestAddr();
+    retry_iterator it = this->retryBuffer.findByAddress(destination);
+    if(it == this->retryBuffer.end()) {
+        Neighbor neighbor(destination);
+        this->retryBuffer.addNeighbor(neighbor);
+        it = this->retryBuffer.findByAddress(destination);
+        if(it == this->retryBuffer.end()) {
+            LOG_DEBUG("DROPPED->" << destination.getShortAddress() << ": Too many destinations waiting for a GTS");
+            return false;
         }
+    }
 
-        if(!oldestEntry->message->getCurrentlySending()) {
-            uint32_t currentSymbolCounter = this->dsmeAdaptionLayer.getDSME().getPlatform().getSymbolCounter();
-            LOG_DEBUG("DROPPED->" << oldestEntry->message->getHeader().getDestAddr().getShortAddress() << ": Retry-Queue overflow ("
-                                  << currentSymbolCounter - oldestEntry->initialSymbolCounter << " symbols old)");
-            DSME_ASSERT(callback_confirm);
-            callback_confirm(oldestEntry->message, DataStatus::Data_Status::INVALID_GTS); // TODO change if queue is used for retransmissions
-            this->retryBuffer.pop();
+    if(this->retryBuffer.getPacketsInQueue(it) >= UPPER_LAYER_QUEUE_SIZE_PER_DESTINATION) {
+        /* '-> this destination used up its share, never take the place of messages for other destinations */
+        if(this->retryOverflowPolicy == RetryOverflowPolicy::DROP_NEWEST) {
+            return false;
+        }
+        dropOldestRetryMessage(it);
+    } else if(this->retryBuffer.isQueueFull()) {
+        /* '-> make room at the cost of the destination with the most waiting messages */
+        retry_iterator longest = it;
+        for(retry_iterator other = this->retryBuffer.begin(); other != this->retryBuffer.end(); ++other) {
+            if(this->retryBuffer.getPacketsInQueue(other) > this->retryBuffer.getPacketsInQueue(longest)) {
+                longest = other;
+            }
+        }
+
+        if(longest == it && this->retryOverflowPolicy == RetryOverflowPolicy::DROP_NEWEST) {
+            return false;
+        }
+
+        dropOldestRetryMessage(longest);
+        if(longest != it && this->retryBuffer.isQueueEmpty(longest)) {
+            this->retryBuffer.eraseNeighbor(longest);
+            it = this->retryBuffer.findByAddress(destination);
         }
     }
-    if(!this->retryBuffer.isFull()) {
-        this->retryBuffer.freeElement()->message = msg;
-        this->retryBuffer.freeElement()->initialSymbolCounter = this->dsmeAdaptionLayer.getDSME().getPlatform().getSymbolCounter();
-        this->retryBuffer.pushFreeElement();
-        return true; /* Do NOT release current message yet */
-    }
-    return false;
+
+    this->retryBuffer.pushBack(it, msg);
+    return true; /* Do NOT release current message yet */
+}
+
+void MessageHelper::dropOldestRetryMessage(NeighborQueue<MAX_NEIGHBORS, UPPER_LAYER_QUEUE_SIZE>::iterator& destination) {
+    IDSMEMessage* oldest = this->retryBuffer.popFront(destination);
+    DSME_ASSERT(oldest != nullptr);
+    DSME_ASSERT(!oldest->getCurrentlySending());
+
+    LOG_DEBUG("DROPPED->" << oldest->getHeader().getDestAddr().getShortAddress() << ": Retry-Queue overflow");
+    DSME_ASSERT(callback_confirm);
+    callback_confirm(oldest, DataStatus::Data_Status::INVALID_GTS); // TODO change if queue is used for retransmissions
 }
 
 void MessageHelper::handleDataConfirm(mcps_sap::DATA_confirm_parameters& params) {
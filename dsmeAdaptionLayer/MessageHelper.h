@@ -44,10 +44,15 @@
 #define MESSAGEHELPER_H_
 
 #include "../../dsme_settings.h"
+#include "../dsmeLayer/neighbors/NeighborQueue.h"
 #include "../helper/DSMEDelegate.h"
-#include "../helper/DSMERingbuffer.h"
 #include "../mac_services/DSME_Common.h"
 
+/* Maximum number of messages waiting for a GTS to a single destination */
+#ifndef UPPER_LAYER_QUEUE_SIZE_PER_DESTINATION
+#define UPPER_LAYER_QUEUE_SIZE_PER_DESTINATION (UPPER_LAYER_QUEUE_SIZE > 1 ? UPPER_LAYER_QUEUE_SIZE / 2 : 1)
+#endif
+
 namespace dsme {
 
 class DSMEAdaptionLayer;
@@ -60,11 +65,10 @@ struct DATA_confirm_parameters;
 struct DATA_indication_parameters;
 } /* namespace mcps_sap */
 
-struct DSMEAdaptionLayerBufferEntry {
-public:
-    IDSMEMessage* message;
-    uint32_t initialSymbolCounter;
-};
+/**
+ * Handling of a message for a destination that already has UPPER_LAYER_QUEUE_SIZE_PER_DESTINATION messages waiting
+ */
+enum class RetryOverflowPolicy : uint8_t { DROP_OLDEST, DROP_NEWEST };
 
 class MessageHelper {
 public:
@@ -78,8 +82,14 @@ public:
     void setIndicationCallback(indicationCallback_t);
     void setConfirmCallback(confirmCallback_t);
 
-    void sendMessage(IDSMEMessage* msg);
-    void sendRetryBuffer();
+    void setRetryOverflowPolicy(RetryOverflowPolicy policy);
+
+    void sendMessage(IDSMEMessage* msg, bool criticalEvent = false);
+
+    /**
+     * Resends the messages waiting for a GTS to the given destination, called when a TX GTS to it was allocated
+     */
+    void sendRetryBuffer(uint16_t deviceAddress);
 
     void startAssociation();
     void handleAssociationComplete(AssociationStatus::Association_Status status);
@@ -91,8 +101,9 @@ private:
 
     void receiveIndication(IDSMEMessage* msg);
 
-    void sendMessageDown(IDSMEMessage* msg, bool newMessage);
+    void sendMessageDown(IDSMEMessage* msg, bool newMessage, bool criticalEvent);
     bool queueMessageIfPossible(IDSMEMessage* msg);
+    void dropOldestRetryMessage(NeighborQueue<MAX_NEIGHBORS, UPPER_LAYER_QUEUE_SIZE>::iterator& destination);
 
     DSMEAdaptionLayer& dsmeAdaptionLayer;
 
@@ -102,7 +113,9 @@ private:
     bool scanOrSyncInProgress;
     bool associationInProgress;
 
-    DSMERingBuffer<DSMEAdaptionLayerBufferEntry, UPPER_LAYER_QUEUE_SIZE> retryBuffer;
+    /* messages waiting for a GTS, the storage is shared but every destination has its own queue */
+    NeighborQueue<MAX_NEIGHBORS, UPPER_LAYER_QUEUE_SIZE> retryBuffer;
+    RetryOverflowPolicy retryOverflowPolicy;
 };
 
 } /* namespace dsme */
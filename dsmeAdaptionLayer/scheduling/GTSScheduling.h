@@ -52,7 +52,7 @@ namespace dsme {
 class DSMEAdaptionLayer;
 
 struct GTSSchedulingData {
-    GTSSchedulingData() : address(0xffff), messagesInLastMultisuperframe(0), messagesOutLastMultisuperframe(0), slotTarget(1) {
+    GTSSchedulingData() : address(0xffff), messagesInLastMultisuperframe(0), messagesOutLastMultisuperframe(0), allocatedSlots(0), slotTarget(1) {
     }
 
     uint16_t address;
@@ -60,6 +60,9 @@ struct GTSSchedulingData {
     uint16_t messagesInLastMultisuperframe;
     uint16_t messagesOutLastMultisuperframe;
 
+    /* number of allocated TX slots at the last updateFromMAC */
+    uint16_t allocatedSlots;
+
     int16_t slotTarget;
 };
 
@@ -92,6 +95,8 @@ public:
     virtual uint8_t registerIncomingMessage(uint16_t address) = 0;
     virtual void registerOutgoingMessage(uint16_t address, bool success, int32_t serviceTime, uint8_t queueAtCreation) = 0;
     virtual void registerReceivedMessage(uint16_t address) = 0;
+    /* copies the state of the MAC required by the scheduling (e.g. from the ACT), the scheduling itself does not access it */
+    virtual void updateFromMAC() = 0;
     virtual void multisuperframeEvent() = 0;
     virtual int16_t getSlotTarget(uint16_t address) = 0;
     virtual uint16_t getPriorityLink() = 0;
@@ -159,6 +164,19 @@ public:
         }
     }
 
+    virtual void updateFromMAC() {
+        for(SchedulingData& d : this->txLinks) {
+            d.allocatedSlots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(d.address, Direction::TX);
+        }
+
+        this->shortAddress = this->dsmeAdaptionLayer.getMAC_PIB().macShortAddress;
+        this->numSuperframesPerMultiSuperframe = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
+        this->numGTSlotsFirstSuperframe = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(0);
+        this->numGTSlotsLatterSuperframes = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(1);
+        this->symbolsPerSlot = this->dsmeAdaptionLayer.getMAC_PIB().helper.getSymbolsPerSlot();
+        this->ackWaitDuration = this->dsmeAdaptionLayer.getMAC_PIB().helper.getAckWaitDuration();
+    }
+
     virtual int16_t getSlotTarget(uint16_t address) {
         iterator it = this->txLinks.find(address);
 
@@ -177,7 +195,7 @@ public:
         uint16_t address = IEEE802154MacAddress::NO_SHORT_ADDRESS;
         int16_t difference = 0;
         for(const SchedulingData& d : this->txLinks) {
-            uint16_t slots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(d.address, Direction::TX);
+            uint16_t slots = d.allocatedSlots;
 
             if(abs(difference) < abs(d.slotTarget - slots)) {
                 difference = d.slotTarget - slots;
@@ -188,15 +206,15 @@ public:
     }
 
     virtual GTSSchedulingDecision getNextSchedulingAction(uint16_t address) {
-        uint16_t numAllocatedSlots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(address, Direction::TX);
+        iterator it = this->txLinks.find(address);
+        uint16_t numAllocatedSlots = it->allocatedSlots;
 
-        int16_t target = getSlotTarget(address);
+        int16_t target = it->slotTarget;
 
         if(target > numAllocatedSlots) {
-            uint8_t numSuperFramesPerMultiSuperframe = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
-            uint8_t randomSuperframeID = this->dsmeAdaptionLayer.getRandom() % numSuperFramesPerMultiSuperframe;
+            uint8_t randomSuperframeID = this->dsmeAdaptionLayer.getRandom() % this->numSuperframesPerMultiSuperframe;
 
-            uint8_t numGTSlots = this->dsmeAdaptionLayer.getMAC_PIB().helper.getNumGTSlots(randomSuperframeID);
+            uint8_t numGTSlots = (randomSuperframeID == 0) ? this->numGTSlotsFirstSuperframe : this->numGTSlotsLatterSuperframes;
             uint8_t randomSlotID = this->dsmeAdaptionLayer.getRandom() % numGTSlots;
 
             return GTSSchedulingDecision{address, ManagementType::ALLOCATION, Direction::TX, 1, randomSuperframeID, randomSlotID};
@@ -221,6 +239,14 @@ protected:
     RBTree<SchedulingData, uint16_t> txLinks;
     RBTree<RxData, uint16_t> rxLinks;
     uint8_t queueLevel = 0;
+
+    /* state of the MAC at the last updateFromMAC */
+    uint16_t shortAddress = IEEE802154MacAddress::NO_SHORT_ADDRESS;
+    uint8_t numSuperframesPerMultiSuperframe = 1;
+    uint8_t numGTSlotsFirstSuperframe = 0;
+    uint8_t numGTSlotsLatterSuperframes = 0;
+    uint32_t symbolsPerSlot = 0;
+    uint16_t ackWaitDuration = 0;
 };
 
 } /* namespace dsme */
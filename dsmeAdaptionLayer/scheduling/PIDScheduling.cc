@@ -80,7 +80,7 @@ void PIDScheduling::multisuperframeEvent() {
             u = (K_P_NEG * e + K_I_NEG * i + K_D_NEG * d) / SCALING;
         }
 
-        uint16_t slots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(data.address, Direction::TX);
+        uint16_t slots = data.allocatedSlots;
         data.slotTarget = slots + u;
 
         if(data.slotTarget < 1) {
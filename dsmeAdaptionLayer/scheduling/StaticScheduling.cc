@@ -53,12 +53,21 @@
 
 namespace dsme {
 
-void StaticScheduling::multisuperframeEvent() {
-    // Reset the idle counters of the slots to prevent deallocation 
+void StaticScheduling::updateFromMAC() {
+    GTSSchedulingImpl::updateFromMAC();
+
+    // Reset the idle counters of the slots to prevent deallocation
     for(DSMEAllocationCounterTable::iterator it = dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.begin(); it != dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.end(); ++it) {
         it->resetIdleCounter();
     }
 
+    this->allocated.resize(this->addresses.size());
+    for(size_t i = 0; i < this->addresses.size(); i++) {
+        this->allocated[i] = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.isAllocated(this->superframes[i], this->slots[i]);
+    }
+}
+
+void StaticScheduling::multisuperframeEvent() {
     // Set priority for the right links 
     for(GTSSchedulingData &data : this->txLinks) {
         data.slotTarget = std::count(this->addresses.begin(), this->addresses.end(), data.address);
@@ -70,9 +79,9 @@ void StaticScheduling::multisuperframeEvent() {
 GTSSchedulingDecision StaticScheduling::getNextSchedulingAction(uint16_t address) {
     if(this->negotiateChannels) {
         //uint8_t nextSlot = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(address, Direction::TX);
-        for(int i=0; i<this->addresses.size(); i++) {
+        for(size_t i=0; i<this->addresses.size(); i++) {
             if(this->newMsf && this->addresses[i] == address) {
-                if(!this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.isAllocated(this->superframes[i], this->slots[i])) {
+                if(i < this->allocated.size() && !this->allocated[i]) {
                     this->newMsf = false;
                     return GTSSchedulingDecision{address, ManagementType::ALLOCATION, Direction::TX, 1, this->superframes[i], this->slots[i]};
                 }
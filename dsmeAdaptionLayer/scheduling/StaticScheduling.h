@@ -59,6 +59,7 @@ public:
     StaticScheduling(DSMEAdaptionLayer& dsmeAdaptionLayer) : GTSSchedulingImpl(dsmeAdaptionLayer), newMsf(false), negotiateChannels(true) {
     }
 
+    virtual void updateFromMAC();
     virtual void multisuperframeEvent();
     virtual GTSSchedulingDecision getNextSchedulingAction(uint16_t address);
 
@@ -70,6 +71,7 @@ private:
     std::vector<uint8_t> superframes;
     std::vector<uint8_t> slots; 
     std::vector<uint16_t> addresses;
+    std::vector<bool> allocated;
     bool newMsf; 
     bool negotiateChannels;
 };
@@ -100,7 +100,7 @@ void TPS::multisuperframeEvent() {
         DSME_ASSERT(minFreshness > 0);
         data.avgIn = data.messagesInLastMultisuperframe * alpha + data.avgIn * (1 - alpha);
 
-        uint8_t slots = this->dsmeAdaptionLayer.getMAC_PIB().macDSMEACT.getNumAllocatedGTS(data.address, Direction::TX);
+        uint8_t slots = data.allocatedSlots;
 
         //LengthFrameInSymbols = Preamble +SFD + PHR + PSDU (PHYPayload)
         //Preamble = 8 symbols;
@@ -109,7 +109,7 @@ void TPS::multisuperframeEvent() {
         //PSDU = MHR + MACPayload + MFR;
         uint8_t packets_per_slot = 1;
         if(useMultiplePacketsPerGTS) {
-            packets_per_slot = (this->dsmeAdaptionLayer.getMAC_PIB().helper.getSymbolsPerSlot() - PRE_EVENT_SHIFT) / ((6 + 127)*2 + this->dsmeAdaptionLayer.getMAC_PIB().helper.getAckWaitDuration() + const_redefines::macLIFSPeriod);
+            packets_per_slot = (this->symbolsPerSlot - PRE_EVENT_SHIFT) / ((6 + 127)*2 + this->ackWaitDuration + const_redefines::macLIFSPeriod);
                 /* '-> calculate number of packets per slot with assumption of maximum packet size and maximum acknowledgement wait duration -> THIS CAN BE DONE MUCH BETTER */
         }
 
@@ -145,7 +145,7 @@ void TPS::multisuperframeEvent() {
         }
 
         LOG_DEBUG("control"
-                  << ",0x" << HEXOUT << this->dsmeAdaptionLayer.getDSME().getMAC_PIB().macShortAddress << ",0x" << data.address << "," << DECOUT
+                  << ",0x" << HEXOUT << this->shortAddress << ",0x" << data.address << "," << DECOUT
                   << data.messagesInLastMultisuperframe << "," << data.messagesOutLastMultisuperframe << "," << FLOAT_OUTPUT(data.avgIn) << ","
                   << (uint16_t)slots << "," << data.slotTarget << "," << data.multisuperframesSinceLastPacket);
 
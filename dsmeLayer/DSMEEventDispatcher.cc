@@ -47,6 +47,7 @@
 #include "../mac_services/pib/PIBHelper.h"
 #include "./DSMELayer.h"
 #include "./ackLayer/AckLayer.h"
+#include "./beaconManager/BeaconManager.h"
 #include "./capLayer/CAPLayer.h"
 
 namespace dsme {
@@ -92,6 +93,10 @@ void DSMEEventDispatcher::fireIFSTimer(int32_t lateness) {
     this->dsme.getMessageDispatcher().handleIFSEvent(lateness);
 }
 
+void DSMEEventDispatcher::fireBeaconTimer(int32_t lateness) {
+    this->dsme.getBeaconManager().handleBeaconTimer();
+}
+
 /********** Setup Methods **********/
 
 uint32_t DSMEEventDispatcher::setupSlotTimer(uint32_t lastSlotTime, uint8_t skippedSlots) {
@@ -118,9 +123,10 @@ void DSMEEventDispatcher::setupCSMATimer(uint32_t absSymCnt) {
     return;
 }
 
-void DSMEEventDispatcher::setupACKTimer() {
+void DSMEEventDispatcher::setupACKTimer(bool enhancedAck) {
+    uint16_t ackWaitDuration = enhancedAck ? dsme.getMAC_PIB().helper.getEnhancedAckWaitDuration() : dsme.getMAC_PIB().helper.getAckWaitDuration();
     DSME_ATOMIC_BLOCK {
-        uint32_t ackTimeout = dsme.getMAC_PIB().helper.getAckWaitDuration() + NOW;
+        uint32_t ackTimeout = ackWaitDuration + NOW;
         DSMETimerMultiplexer::_startTimer<ACK_TIMER>(ackTimeout, &DSMEEventDispatcher::fireACKTimer);
         DSMETimerMultiplexer::_scheduleTimer();
     }
@@ -152,4 +158,12 @@ void DSMEEventDispatcher::stopIFSTimer() {
     return;
 }
 
+void DSMEEventDispatcher::setupBeaconTimer(uint32_t absSymCnt) {
+    DSME_ATOMIC_BLOCK {
+        DSMETimerMultiplexer::_startTimer<BEACON_TIMER>(absSymCnt, &DSMEEventDispatcher::fireBeaconTimer);
+        DSMETimerMultiplexer::_scheduleTimer();
+    }
+    return;
+}
+
 } /* namespace dsme */
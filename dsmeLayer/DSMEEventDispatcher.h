@@ -58,8 +58,9 @@ enum EventTimers {
     NEXT_SLOT,
     CSMA_TIMER,
     ACK_TIMER,
-    IFS_TIMER,  /* IFS after dataframe transmission */
-    TIMER_COUNT /* always last element */
+    IFS_TIMER,    /* IFS after dataframe transmission */
+    BEACON_TIMER, /* end of the deferral of a beacon */
+    TIMER_COUNT   /* always last element */
 };
 
 class DSMEEventDispatcher;
@@ -76,7 +77,7 @@ public:
 
     uint32_t setupSlotTimer(uint32_t lastSlotTime, uint8_t skippedSlots);
     void setupCSMATimer(uint32_t absSymCnt);
-    void setupACKTimer();
+    void setupACKTimer(bool enhancedAck);
     void stopACKTimer();
 
     /*! Sets up a timer for a SIFS (12 sybols) or LIFS (40 symbols).
@@ -85,6 +86,8 @@ public:
     void setupIFSTimer(bool LIFS);
     void stopIFSTimer();
 
+    void setupBeaconTimer(uint32_t absSymCnt);
+
 private:
     DSMELayer& dsme;
 
@@ -93,6 +96,7 @@ private:
     void fireCSMATimer(int32_t lateness);
     void fireACKTimer(int32_t lateness);
     void fireIFSTimer(int32_t lateness);
+    void fireBeaconTimer(int32_t lateness);
 
     ReadonlyTimerAbstraction<IDSMEPlatform> NOW;
     WriteonlyTimerAbstraction<IDSMEPlatform> TIMER;
@@ -47,6 +47,8 @@
 #include "../helper/ChannelHoppingLFSR.h"
 #include "../helper/DSMEAtomic.h"
 #include "../interfaces/IDSMEPlatform.h"
+#include "../mac_services/mlme_sap/MLME_SAP.h"
+#include "../mac_services/mlme_sap/POLL.h"
 #include "../mac_services/pib/MAC_PIB.h"
 #include "../mac_services/pib/PIBHelper.h"
 #include "../mac_services/pib/dsme_mac_constants.h"
@@ -61,6 +63,13 @@ DSMELayer::DSMELayer()
 
       platform(nullptr),
       eventDispatcher(*this),
+      startOfCFPSuperframe(0),
+#ifdef DSME_THREADED_UPPER_HALF
+      upperHalf(*this),
+      latestStartOfCFPSuperframe(0),
+      startOfCFPPending(false),
+      startOfCFPFirstSuperframeSeen(false),
+#endif
 
       ackLayer(*this),
       capLayer(*this),
@@ -76,8 +85,10 @@ DSMELayer::DSMELayer()
       nextSuperframe(0),
       nextMultiSuperframe(0),
       trackingBeacons(false),
+      currentSlotTime(0),
       nextSlotTime(0),
-      resetPending(false) {
+      resetPending(false),
+      resumePending(false) {
 }
 
 void DSMELayer::initialize(IDSMEPlatform* platform) {
@@ -90,6 +101,7 @@ void DSMELayer::initialize(IDSMEPlatform* platform) {
     this->currentMultiSuperframe = 0;
 
     this->eventDispatcher.initialize();
+    this->ackLayer.initialize();
     this->gtsManager.initialize();
     this->messageDispatcher.initialize();
     this->beaconManager.initialize();
@@ -97,18 +109,35 @@ void DSMELayer::initialize(IDSMEPlatform* platform) {
     this->mac_pib->macDsn = platform->getRandom();
 
     if(this->mac_pib->macChannelDiversityMode == Channel_Diversity_Mode::CHANNEL_HOPPING) {
-        /* compute default hopping sequence */
-        this->mac_pib->macHoppingSequenceLength = mac_pib->helper.getNumChannels();
-        this->mac_pib->macHoppingSequenceList.setLength(this->mac_pib->macHoppingSequenceLength);
-        for(int i = 0; i < this->mac_pib->macHoppingSequenceLength; i++) {
-            this->mac_pib->macHoppingSequenceList[i] = this->mac_pib->helper.getChannels()[i];
+        /* compute default hopping sequence
+         * If a hopping sequence length larger than the number of channels was configured, the sequence
+         * consists of consecutive blocks that are each an LFSR shuffled permutation of all channels. */
+        uint8_t numChannels = mac_pib->helper.getNumChannels();
+        uint16_t hoppingSequenceLength = this->mac_pib->macHoppingSequenceLength;
+        if(hoppingSequenceLength < numChannels) {
+            hoppingSequenceLength = numChannels;
+        }
+        if(hoppingSequenceLength > DSME_MAX_HOPPING_SEQUENCE_LENGTH) {
+            hoppingSequenceLength = DSME_MAX_HOPPING_SEQUENCE_LENGTH;
+        }
+
+        this->mac_pib->macHoppingSequenceLength = hoppingSequenceLength;
+        this->mac_pib->macHoppingSequenceList.setLength(hoppingSequenceLength);
+        for(uint16_t i = 0; i < hoppingSequenceLength; i++) {
+            this->mac_pib->macHoppingSequenceList[i] = this->mac_pib->helper.getChannels()[i % numChannels];
         }
         ChannelHoppingLFSR lfsr;
-        for(int i = 0; i < this->mac_pib->macHoppingSequenceLength; i++) {
-            uint8_t ch_cpy = this->mac_pib->macHoppingSequenceList[i];
-            uint8_t shuffle = lfsr.next() % this->mac_pib->macHoppingSequenceLength;
-            this->mac_pib->macHoppingSequenceList[i] = this->mac_pib->macHoppingSequenceList[shuffle];
-            this->mac_pib->macHoppingSequenceList[shuffle] = ch_cpy;
+        for(uint16_t blockStart = 0; blockStart < hoppingSequenceLength; blockStart += numChannels) {
+            uint16_t blockLength = hoppingSequenceLength - blockStart;
+            if(blockLength > numChannels) {
+                blockLength = numChannels;
+            }
+            for(uint16_t i = blockStart; i < blockStart + blockLength; i++) {
+                uint16_t ch_cpy = this->mac_pib->macHoppingSequenceList[i];
+                uint16_t shuffle = blockStart + lfsr.next() % blockLength;
+                this->mac_pib->macHoppingSequenceList[i] = this->mac_pib->macHoppingSequenceList[shuffle];
+                this->mac_pib->macHoppingSequenceList[shuffle] = ch_cpy;
+            }
         }
     }
 }
@@ -151,6 +180,7 @@ void DSMELayer::doReset() {
         this->currentMultiSuperframe = 0;
 
         this->trackingBeacons = false;
+        this->resumePending = false;
     }
 
     /* restart slot timer */
@@ -170,7 +200,7 @@ void DSMELayer::preSlotEvent(void) {
     }
 
     // calculate time within next slot
-    uint32_t cnt = platform->getSymbolCounter() - beaconManager.getLastKnownBeaconIntervalStart() + PRE_EVENT_SHIFT + 1;
+    uint32_t cnt = getSymbolsSinceLastKnownBeaconIntervalStart(platform->getSymbolCounter()) + PRE_EVENT_SHIFT + 1;
 
     // calculate slot position
     uint16_t slotsSinceLastKnownBeaconIntervalStart = cnt / getMAC_PIB().helper.getSymbolsPerSlot();
@@ -206,13 +236,11 @@ void DSMELayer::slotEvent(int32_t lateness) {
         DSME_ASSERT(false);
     }
 
-    uint32_t currentSlotTime;
-
     // TODO set timer to next relevant slot only!
     // TODO in that case currentSlot might be used even if no slotEvent was called before -> calculate then
     if(this->trackingBeacons) {
         auto now = platform->getSymbolCounter();
-        currentSlotTime = now - (now - beaconManager.getLastKnownBeaconIntervalStart()) % getMAC_PIB().helper.getSymbolsPerSlot();
+        currentSlotTime = now - getSymbolsSinceLastKnownBeaconIntervalStart(now) % getMAC_PIB().helper.getSymbolsPerSlot();
     } else {
         currentSlotTime = this->nextSlotTime;
     }
@@ -222,10 +250,16 @@ void DSMELayer::slotEvent(int32_t lateness) {
         if(this->mac_pib->macCapReduction && currentSuperframe > 0) {
             // no CAP available
             skippedSlots = 0;
+        } else if(this->mac_pib->macMultiChannelCAP) {
+            // the pre slot event of the second CAP slot switches to the own CAP channel
+            skippedSlots = 0;
         } else {
             // no (pre) slot events required during CAP
             skippedSlots = 7;
         }
+    } else if(currentSlot == 2 && this->mac_pib->macMultiChannelCAP && getMAC_PIB().helper.getFinalCAPSlot(currentSuperframe) >= 2) {
+        // no further (pre) slot events required during CAP
+        skippedSlots = 6;
     }
 
     this->nextSlotTime = eventDispatcher.setupSlotTimer(currentSlotTime, skippedSlots);
@@ -250,17 +284,49 @@ void DSMELayer::handleStartOfCFP() {
 #endif
 
     if(this->startOfCFPDelegate) {
+#ifdef DSME_THREADED_UPPER_HALF
+        /* '-> if the upper half lags behind, the starts of CFP are coalesced into the pending call */
+        this->latestStartOfCFPSuperframe = this->currentSuperframe;
+        if(this->currentSuperframe == 0) {
+            this->startOfCFPFirstSuperframeSeen = true;
+        }
+        if(!this->startOfCFPPending) {
+            this->startOfCFPPending = true;
+            this->upperHalf.post(DELEGATE(&DSMELayer::handleStartOfCFPInUpperHalf, *this));
+        }
+#else
+        this->startOfCFPSuperframe = this->currentSuperframe;
         this->startOfCFPDelegate();
+#endif
     }
 
     this->capLayer.handleStartOfCFP();
     this->gtsManager.handleStartOfCFP(this->currentSuperframe);
     this->associationManager.handleStartOfCFP(this->currentSuperframe);
     this->beaconManager.handleStartOfCFP(this->currentSuperframe, this->currentMultiSuperframe);
+    this->messageDispatcher.handleStartOfCFP();
+    this->getMLME_SAP().getPOLL().handleStartOfCFP();
+}
+
+#ifdef DSME_THREADED_UPPER_HALF
+void DSMELayer::handleStartOfCFPInUpperHalf() {
+    /* '-> runs with the lower half lock held like handleStartOfCFP, so no further synchronization is required */
+    this->startOfCFPPending = false;
+
+    /* a skipped start of a multi-superframe is not lost, since the scheduling is updated there */
+    this->startOfCFPSuperframe = this->startOfCFPFirstSuperframeSeen ? 0 : this->latestStartOfCFPSuperframe;
+    this->startOfCFPFirstSuperframeSeen = false;
+    this->startOfCFPDelegate();
+}
+#endif
+
+uint32_t DSMELayer::getSymbolsSinceLastKnownBeaconIntervalStart(uint32_t time) {
+    uint32_t symbols = time - this->beaconManager.getLastKnownBeaconIntervalStart();
+    return symbols - this->beaconManager.getDriftCorrection(symbols);
 }
 
 uint32_t DSMELayer::getSymbolsSinceCapFrameStart(uint32_t time) {
-    uint32_t symbolsSinceLastBeaconInterval = time - this->beaconManager.getLastKnownBeaconIntervalStart();
+    uint32_t symbolsSinceLastBeaconInterval = getSymbolsSinceLastKnownBeaconIntervalStart(time);
 
     if(this->mac_pib->macCapReduction) {
         uint32_t symbolsPerMultiSuperframe = aNumSuperframeSlots * (uint32_t)aBaseSlotDuration * (1 << (uint32_t) this->mac_pib->macMultiSuperframeOrder);
@@ -287,9 +353,9 @@ bool DSMELayer::isWithinCAP(uint32_t time, uint16_t duration) {
 
 bool DSMELayer::isWithinTimeSlot(uint32_t now, uint16_t duration) {
     uint32_t symbolsPerSlot = getMAC_PIB().helper.getSymbolsPerSlot();
-    uint32_t symbolsSinceLastBeaconInterval = now - this->beaconManager.getLastKnownBeaconIntervalStart();
+    uint32_t symbolsSinceLastBeaconInterval = getSymbolsSinceLastKnownBeaconIntervalStart(now);
 
-    uint32_t timeSlotStart = (symbolsSinceLastBeaconInterval / symbolsPerSlot) * symbolsPerSlot + this->beaconManager.getLastKnownBeaconIntervalStart();
+    uint32_t timeSlotStart = now - symbolsSinceLastBeaconInterval % symbolsPerSlot;
     uint32_t timeSlotEnd = timeSlotStart + symbolsPerSlot - PRE_EVENT_SHIFT;
 
     DSME_ASSERT(now >= timeSlotStart && now <= timeSlotEnd);
@@ -313,4 +379,118 @@ bool DSMELayer::isTrackingBeacons() const {
     return this->trackingBeacons;
 }
 
+uint16_t DSMELayer::getStateSerializationLength() {
+    return STATE_HEADER_LENGTH + BeaconManager::STATE_SERIALIZATION_LENGTH + getMAC_PIB().macDSMEACT.getSerializationLength() +
+           getMAC_PIB().macDSMESAB.getSerializationLength();
+}
+
+uint16_t DSMELayer::saveState(uint8_t* buffer, uint16_t length) {
+    if(!getMAC_PIB().macAssociatedPANCoord || getMAC_PIB().macIsPANCoord || resumePending) {
+        /* '-> nothing to resume, a PAN coordinator simply starts again */
+        return 0;
+    }
+
+    uint16_t stateLength = getStateSerializationLength();
+    if(length < stateLength) {
+        return 0;
+    }
+
+    Serializer serializer(buffer, SERIALIZATION);
+    DSME_ATOMIC_BLOCK {
+        serializeStateHeader(serializer);
+        this->beaconManager.serializeState(serializer);
+        serializer << getMAC_PIB().macDSMEACT;
+        serializer << getMAC_PIB().macDSMESAB;
+    }
+
+    DSME_ASSERT(serializer.getData() - buffer == stateLength);
+    return stateLength;
+}
+
+bool DSMELayer::restoreState(uint8_t* buffer, uint16_t length) {
+    DSME_ASSERT(!resumePending);
+
+    uint16_t fixedLength = STATE_HEADER_LENGTH + BeaconManager::STATE_SERIALIZATION_LENGTH + 2 + getMAC_PIB().macDSMESAB.getSerializationLength();
+    if(length < fixedLength || buffer[0] != STATE_VERSION || buffer[1] != getMAC_PIB().macBeaconOrder || buffer[2] != getMAC_PIB().macMultiSuperframeOrder ||
+       buffer[3] != getMAC_PIB().macSuperframeOrder || buffer[4] != getMAC_PIB().helper.getNumChannels() || buffer[5] != getMAC_PIB().macChannelDiversityMode) {
+        LOG_INFO("Stored state does not match the configuration -> not restored");
+        return false;
+    }
+
+    /* the number of ACT elements is the first field after the beacon state */
+    uint8_t* actStart = buffer + STATE_HEADER_LENGTH + BeaconManager::STATE_SERIALIZATION_LENGTH;
+    uint16_t numACTElements = actStart[0] | (actStart[1] << 8);
+    if(length < fixedLength + numACTElements * DSMEAllocationCounterTable::SERIALIZED_ELEMENT_LENGTH) {
+        LOG_INFO("Stored state is truncated -> not restored");
+        return false;
+    }
+
+    Serializer serializer(buffer, DESERIALIZATION);
+    serializeStateHeader(serializer);
+    this->beaconManager.serializeState(serializer);
+    serializer << getMAC_PIB().macDSMEACT;
+    serializer << getMAC_PIB().macDSMESAB;
+
+    for(DSMEAllocationCounterTable::iterator it = getMAC_PIB().macDSMEACT.begin(); it != getMAC_PIB().macDSMEACT.end(); ++it) {
+        IEEE802154MacAddress address(it->getAddress());
+        if(!this->messageDispatcher.neighborExists(address)) {
+            this->messageDispatcher.addNeighbor(address);
+        }
+    }
+
+    LOG_INFO("Restored state with SYNC parent " << getMAC_PIB().macSyncParentShortAddress << ", waiting for its beacon.");
+    this->resumePending = true;
+    startTrackingBeacons();
+    return true;
+}
+
+void DSMELayer::serializeStateHeader(Serializer& serializer) {
+    MAC_PIB& pib = getMAC_PIB();
+
+    uint8_t version = STATE_VERSION;
+    uint8_t numChannels = pib.helper.getNumChannels();
+    uint8_t channelDiversityMode = pib.macChannelDiversityMode;
+    uint8_t flags = (pib.macAssociatedPANCoord ? 1 : 0) | (pib.macIsCoord ? 2 : 0);
+
+    serializer << version;
+    serializer << pib.macBeaconOrder;
+    serializer << pib.macMultiSuperframeOrder;
+    serializer << pib.macSuperframeOrder;
+    serializer << numChannels;
+    serializer << channelDiversityMode;
+    serializer << pib.macPANId;
+    serializer << pib.macShortAddress;
+    serializer << pib.macCoordShortAddress;
+    serializer << pib.macCoordExtendedAddress;
+    serializer << flags;
+    serializer << pib.macSyncParentShortAddress;
+    serializer << pib.macSyncParentSdIndex;
+    serializer << getPHY_PIB().phyCurrentChannel;
+    serializer << getPHY_PIB().phyCurrentPage;
+
+    if(serializer.getType() == DESERIALIZATION) {
+        pib.macAssociatedPANCoord = flags & 1;
+        pib.macIsCoord = flags & 2;
+    }
+}
+
+void DSMELayer::finishResume(bool success) {
+    DSME_ASSERT(resumePending);
+    resumePending = false;
+
+    if(success) {
+        LOG_INFO("Restored state confirmed by the SYNC parent.");
+    } else {
+        LOG_INFO("Restored state rejected, discarding it.");
+        getMAC_PIB().macDSMEACT.clear();
+        getMAC_PIB().macDSMESAB.clear();
+        this->beaconManager.reset();
+        this->associationManager.reset();
+    }
+
+    if(this->resumeCompleteDelegate) {
+        this->resumeCompleteDelegate(success);
+    }
+}
+
 } /* namespace dsme */
@@ -50,6 +50,7 @@
 #include "../interfaces/IDSMEMessage.h"
 #include "../interfaces/IDSMEPlatform.h"
 #include "./DSMEEventDispatcher.h"
+#include "./DSMEUpperHalfDispatcher.h"
 #include "./ackLayer/AckLayer.h"
 #include "./associationManager/AssociationManager.h"
 #include "./beaconManager/BeaconManager.h"
@@ -150,6 +151,19 @@ public:
         startOfCFPDelegate = delegate;
     }
 
+    /**
+     * Superframe in which the CFP started that the start of CFP delegate is currently called for
+     */
+    uint16_t getStartOfCFPSuperframe() const {
+        return startOfCFPSuperframe;
+    }
+
+#ifdef DSME_THREADED_UPPER_HALF
+    DSMEUpperHalfDispatcher& getUpperHalf() {
+        return upperHalf;
+    }
+#endif
+
     DSMEEventDispatcher& getEventDispatcher() {
         return eventDispatcher;
     }
@@ -171,7 +185,11 @@ public:
     }
 
     void dispatchCCAResult(bool success) {
-        this->capLayer.dispatchCCAResult(success);
+        if(this->beaconManager.isBeaconCCAPending()) {
+            this->beaconManager.handleBeaconCCAResult(success);
+        } else {
+            this->capLayer.dispatchCCAResult(success);
+        }
     }
 
     void preSlotEvent(void);
@@ -179,6 +197,11 @@ public:
 
     uint32_t getSymbolsSinceCapFrameStart(uint32_t time);
 
+    /** Symbols since the last known beacon interval start, compensated by the estimated drift to the SYNC parent.
+     *\param time Current time in symbols
+     */
+    uint32_t getSymbolsSinceLastKnownBeaconIntervalStart(uint32_t time);
+
     /** Checks if \p time + \p duration is withing a CAP.
      *\param time Current time in symbols
      *\param duration Duration in symbols
@@ -201,16 +224,70 @@ public:
         return currentSlot;
     }
 
+    /**
+     * Start of the current slot in symbols
+     */
+    uint32_t getCurrentSlotTime() const {
+        return currentSlotTime;
+    }
+
     void handleStartOfCFP();
 
     void startTrackingBeacons();
     void stopTrackingBeacons();
     bool isTrackingBeacons() const;
 
+    /* WARM RESTART -------------------------------------------------------> */
+
+    /**
+     * Number of bytes required by saveState() for the current state
+     */
+    uint16_t getStateSerializationLength();
+
+    /**
+     * Stores the slot allocations (macDSMEACT, macDSMESAB), the association and the SYNC parent
+     * so that a restarted node can resume without scanning, associating and negotiating its GTS again.
+     *\return number of bytes written, 0 if \p length is too small or the device is not associated
+     */
+    uint16_t saveState(uint8_t* buffer, uint16_t length);
+
+    /**
+     * Restores a state stored by saveState(), has to be called after initialize() and before start().
+     * The beacons of the SYNC parent are tracked right away, but the GTS and the own beacon are only used after
+     * the first beacon of the SYNC parent confirmed the restored state. Otherwise the state is discarded and a SYNC-LOSS is indicated.
+     *\return false if the state is invalid or was stored with a different configuration
+     */
+    bool restoreState(uint8_t* buffer, uint16_t length);
+
+    bool isResumePending() const {
+        return resumePending;
+    }
+
+    /**
+     * Called by the BeaconManager when the restored state was confirmed or has to be discarded
+     */
+    void finishResume(bool success);
+
+    void setResumeCompleteDelegate(Delegate<void(bool)> delegate) {
+        resumeCompleteDelegate = delegate;
+    }
+    /* <------------------------------------------------------- WARM RESTART */
+
 protected:
     IDSMEPlatform* platform;
     DSMEEventDispatcher eventDispatcher;
     Delegate<void()> startOfCFPDelegate;
+    Delegate<void(bool)> resumeCompleteDelegate;
+    uint16_t startOfCFPSuperframe;
+
+#ifdef DSME_THREADED_UPPER_HALF
+    DSMEUpperHalfDispatcher upperHalf;
+    uint16_t latestStartOfCFPSuperframe;
+    bool startOfCFPPending;
+    bool startOfCFPFirstSuperframeSeen;
+
+    void handleStartOfCFPInUpperHalf();
+#endif
 
 #ifdef STATISTICS_MONITOR_LATENESS
     int latenessStatisticsCount;
@@ -235,11 +312,21 @@ protected:
     uint16_t nextMultiSuperframe;
 
     bool trackingBeacons;
+    uint32_t currentSlotTime;
     uint32_t nextSlotTime;
     bool resetPending;
+    bool resumePending;
+
+    static constexpr uint8_t STATE_VERSION = 1;
+    static constexpr uint8_t STATE_HEADER_LENGTH = 27;
 
     void doReset();
 
+    /**
+     * Stores or restores the association and SYNC parent fields of the PIB
+     */
+    void serializeStateHeader(Serializer& serializer);
+
     /**
      * Called every slot to display node status in GUI
      * TODO currently platform specific!
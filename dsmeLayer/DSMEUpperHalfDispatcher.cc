@@ -0,0 +1,87 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./DSMEUpperHalfDispatcher.h"
+
+#ifdef DSME_THREADED_UPPER_HALF
+
+#include "../../dsme_platform.h"
+#include "./DSMELayer.h"
+
+namespace dsme {
+
+DSMEUpperHalfDispatcher::DSMEUpperHalfDispatcher(DSMELayer& dsme) : dsme(dsme), processing(false) {
+}
+
+void DSMEUpperHalfDispatcher::post(Delegate<void()> call) {
+    bool canAdd = this->calls.push(call);
+    DSME_ASSERT(canAdd); // every source posts at most one call at a time, so this should never trigger for a suitable UPPER_HALF_QUEUE_SIZE
+
+    this->dsme.getPlatform().scheduleUpperHalf();
+}
+
+void DSMEUpperHalfDispatcher::process() {
+    if(this->processing.exchange(true, std::memory_order_acquire)) {
+        /* '-> another worker is already processing the calls */
+        return;
+    }
+
+    do {
+        Delegate<void()>* next;
+        while((next = this->calls.front()) != nullptr) {
+            Delegate<void()> call = *next;
+            this->calls.pop();
+
+            this->dsme.getPlatform().lockLowerHalf();
+            call();
+            this->dsme.getPlatform().unlockLowerHalf();
+        }
+        this->processing.store(false, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        /* a call posted after the queue was found empty may have woken a worker that returned immediately */
+    } while(!this->calls.isEmpty() && !this->processing.exchange(true, std::memory_order_acquire));
+}
+
+} /* namespace dsme */
+
+#endif /* DSME_THREADED_UPPER_HALF */
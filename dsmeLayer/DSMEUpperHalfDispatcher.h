@@ -0,0 +1,112 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DSMEUPPERHALFDISPATCHER_H_
+#define DSMEUPPERHALFDISPATCHER_H_
+
+#include "../../dsme_settings.h"
+
+#ifdef DSME_THREADED_UPPER_HALF
+
+#include <atomic>
+
+#include "../helper/DSMEDelegate.h"
+#include "../helper/DSMELockFreeRingbuffer.h"
+#include "../helper/Integers.h"
+
+#ifndef UPPER_HALF_QUEUE_SIZE
+#define UPPER_HALF_QUEUE_SIZE 32
+#endif
+
+#ifndef UPPER_HALF_PRIMITIVE_QUEUE_SIZE
+#define UPPER_HALF_PRIMITIVE_QUEUE_SIZE 16
+#endif
+
+namespace dsme {
+
+class DSMELayer;
+
+/**
+ * Threaded execution model, enabled by defining DSME_THREADED_UPPER_HALF (e.g. in dsme_settings.h).
+ *
+ * Lower half: the slot engine, i.e. DSMEEventDispatcher::timerInterrupt, the radio callbacks of the AckLayer, the
+ * reception of messages and DSMELayer::handleStartOfCFP. The platform runs it on a dedicated real-time thread and holds
+ * the lower half lock (IDSMEPlatform::lockLowerHalf) while handling each of these events.
+ *
+ * Upper half: the MLME/MCPS confirm and indication callbacks and the start of CFP delegate, i.e. the adaption layer
+ * including the GTS scheduling. The lower half never calls them directly, but copies the parameters into a lock-free
+ * queue of the primitive and posts the delivery here. The platform then calls process() from one or more worker threads.
+ * Calls are processed one at a time, each while holding the lower half lock, because the upper half reads and modifies
+ * the state of the MAC (PIB, ACT, queues) and issues requests. The lower half is therefore delayed by at most one
+ * callback instead of the whole upper layer processing; longer running work of the application has to be handed to
+ * the application's own threads.
+ * If the queue of a primitive is full, its parameters are delivered synchronously instead, since the caller holds the
+ * lower half lock anyway. Starts of CFP are coalesced while the upper half lags behind.
+ * The GTS scheduling is computed without the lock on a copy of the MAC state (GTSScheduling::updateFromMAC), because
+ * its own state is only accessed by the upper half. The application therefore has to use the adaption layer from the
+ * upper half, too, e.g. by posting a call.
+ */
+class DSMEUpperHalfDispatcher {
+public:
+    explicit DSMEUpperHalfDispatcher(DSMELayer& dsme);
+
+    /**
+     * Queues a call for the upper half and wakes a worker, may be called from any thread
+     */
+    void post(Delegate<void()> call);
+
+    /**
+     * Runs all pending calls, returns immediately if another worker is already processing them
+     */
+    void process();
+
+private:
+    DSMELayer& dsme;
+    std::atomic<bool> processing;
+    DSMEMPSCRingBuffer<Delegate<void()>, UPPER_HALF_QUEUE_SIZE> calls;
+};
+
+} /* namespace dsme */
+
+#endif /* DSME_THREADED_UPPER_HALF */
+
+#endif /* DSMEUPPERHALFDISPATCHER_H_ */
@@ -51,17 +51,47 @@
 #include "../../mac_services/DSME_Common.h"
 #include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
 #include "../../mac_services/pib/MAC_PIB.h"
+#include "../../mac_services/pib/PHY_PIB.h"
 #include "../DSMEEventDispatcher.h"
 #include "../DSMELayer.h"
+#include "../beaconManager/BeaconManager.h"
+#include "../messageDispatcher/MessageDispatcher.h"
 #include "../messages/IEEE802154eMACHeader.h"
 
 namespace dsme {
 
 AckLayer::AckLayer(DSMELayer& dsme)
-    : DSMEBufferedFSM<AckLayer, AckEvent, 2>(&AckLayer::stateIdle), dsme(dsme), internalDoneCallback(DELEGATE(&AckLayer::sendDone, *this)) {
+    : DSMEBufferedFSM<AckLayer, AckEvent, 3>(&AckLayer::stateIdle), dsme(dsme), internalDoneCallback(DELEGATE(&AckLayer::sendDone, *this)) {
+}
+
+void AckLayer::initialize() {
+    updateAddressFilter();
+
+    /* allocate the ACK once, so the path from reception to ACK does not allocate, a repeated initialization reuses it
+     * the header is only finalized with the first transmission, patching the sequence number afterwards keeps it finalized */
+    if(this->ackTemplate == nullptr) {
+        this->ackTemplate = this->dsme.getPlatform().getEmptyMessage();
+        DSME_ASSERT(this->ackTemplate != nullptr);
+    }
+    this->ackTemplate->getHeader().setFrameType(IEEE802154eMACHeader::ACKNOWLEDGEMENT);
 }
 
 void AckLayer::reset() {
+    /* drop the queued receptions first, so they are not handled when the FSM returns to idle */
+    IDSMEMessage* queued = nullptr;
+    do {
+        queued = nullptr;
+        DSME_ATOMIC_BLOCK {
+            if(!this->rxQueue.isEmpty()) {
+                queued = *this->rxQueue.front();
+                this->rxQueue.pop();
+            }
+        }
+        if(queued != nullptr) {
+            this->dsme.getPlatform().releaseMessage(queued);
+        }
+    } while(queued != nullptr);
+
     bool dispatchSuccessful = dispatch(AckEvent::RESET);
     DSME_ASSERT(dispatchSuccessful);
 }
@@ -102,6 +132,48 @@ void AckLayer::abortPreparedTransmission() {
     }
 }
 
+bool AckLayer::isAddressedToMe(const uint8_t* frame, uint8_t length) {
+    if(this->addressFilter.isOutdated(this->dsme.getMAC_PIB())) {
+        updateAddressFilter();
+    }
+    return this->addressFilter.accept(frame, length);
+}
+
+bool AckLayer::isReceptionPossible() {
+#ifdef DSME_LOCK_FREE_QUEUES
+    return !this->receivedMessages.isFull();
+#else
+    return dsme.getPlatform().isReceptionFromAckLayerPossible();
+#endif
+}
+
+void AckLayer::passReceivedMessageUp(IDSMEMessage* msg) {
+#ifdef DSME_LOCK_FREE_QUEUES
+    /* '-> checked by isReceptionPossible before, only the consumer can free further elements in the meantime */
+    *(this->receivedMessages.freeElement()) = msg;
+    this->receivedMessages.pushFreeElement();
+    dsme.getPlatform().scheduleReceivedMessages();
+#else
+    dsme.getPlatform().handleReceivedMessageFromAckLayer(msg);
+#endif
+}
+
+#ifdef DSME_LOCK_FREE_QUEUES
+void AckLayer::processReceivedMessages() {
+    while(!this->receivedMessages.isEmpty()) {
+        IDSMEMessage* msg = *(this->receivedMessages.front());
+        this->receivedMessages.pop();
+        dsme.getMessageDispatcher().receive(msg);
+    }
+}
+#endif
+
+void AckLayer::updateAddressFilter() {
+    DSME_ATOMIC_BLOCK {
+        this->addressFilter.update(this->dsme.getMAC_PIB());
+    }
+}
+
 void AckLayer::receive(IDSMEMessage* msg) {
     IEEE802154eMACHeader& header = msg->getHeader();
 
@@ -119,46 +191,58 @@ void AckLayer::receive(IDSMEMessage* msg) {
     if(header.getFrameType() == IEEE802154eMACHeader::ACKNOWLEDGEMENT) {
         LOG_DEBUG("ACK_RECEIVED with seq num " << (uint16_t)header.getSequenceNumber());
         uint8_t seqNum = header.getSequenceNumber();
+        bool hasTimeCorrection = header.hasTimeCorrection();
+        int16_t timeCorrection = header.getTimeCorrection();
         dsme.getPlatform().releaseMessage(msg);
         DSME_ASSERT(!isDispatchBusy());
-        bool dispatchSuccessful = dispatch(AckEvent::ACK_RECEIVED, seqNum);
+        bool dispatchSuccessful;
+        if(hasTimeCorrection) {
+            dispatchSuccessful = dispatch(AckEvent::ACK_RECEIVED, seqNum, timeCorrection);
+        } else {
+            dispatchSuccessful = dispatch(AckEvent::ACK_RECEIVED, seqNum);
+        }
         DSME_ASSERT(dispatchSuccessful);
         return;
     }
 
     /* filter messages not for this device */
-    bool throwawayMessage = false;
-    if(this->dsme.getMAC_PIB().macAssociatedPANCoord && header.hasDestinationPANId() && header.getDstPANId() != this->dsme.getMAC_PIB().macPANId &&
-       header.getDstPANId() != IEEE802154eMACHeader::BROADCAST_PAN) {
-        LOG_DEBUG("Mismatching PAN-ID: " << header.getDstPANId() << " instead of " << this->dsme.getMAC_PIB().macPANId << " from "
-                                         << header.getSrcAddr().getShortAddress());
-        throwawayMessage = true;
-    } else if(!header.getDestAddr().isBroadcast()) {
-        if(header.getDstAddrMode() == SHORT_ADDRESS && header.getDestAddr().getShortAddress() != this->dsme.getMAC_PIB().macShortAddress) {
-            throwawayMessage = true;
-        } else if(header.getDstAddrMode() == EXTENDED_ADDRESS && header.getDestAddr() != this->dsme.getMAC_PIB().macExtendedAddress) {
-            throwawayMessage = true;
-        }
+    if(this->addressFilter.isOutdated(this->dsme.getMAC_PIB())) {
+        updateAddressFilter();
     }
-
-    if(throwawayMessage) {
+    if(!this->addressFilter.accept(header)) {
+        LOG_DEBUG("Mismatching destination from " << header.getSrcAddr().getShortAddress());
         this->dsme.getPlatform().releaseMessage(msg);
         return;
     }
 
-    /* also throw away the packet if the FSM is busy */
+    /* keep the packet until the FSM is idle again, throw it away only if the receive queue is full */
+    bool queued = false;
+    bool overflow = false;
     DSME_ATOMIC_BLOCK {
         if(busy) {
-            LOG_DEBUG("Throwing away packet, ACKLayer was busy.");
-            this->dsme.getPlatform().releaseMessage(msg);
-            // DSME_SIM_ASSERT(false);
-            return;
+            if(this->rxQueue.isFull()) {
+                overflow = true;
+                this->numRxQueueOverflows++;
+            } else {
+                *this->rxQueue.freeElement() = msg;
+                this->rxQueue.pushFreeElement();
+                queued = true;
+            }
         } else {
             busy = true;
         }
     }
 
+    if(overflow) {
+        LOG_DEBUG("Throwing away packet, ACKLayer was busy and receive queue is full.");
+        this->dsme.getPlatform().releaseMessage(msg);
+        return;
+    } else if(queued) {
+        return;
+    }
+
     this->pendingMessage = msg;
+    this->handlingQueuedReception = false;
     DSME_ASSERT(!isDispatchBusy());
     bool dispatchSuccessful = dispatch(AckEvent::RECEIVE_REQUEST);
     DSME_ASSERT(dispatchSuccessful);
@@ -189,6 +273,37 @@ void AckLayer::sendDone(bool success) {
     DSME_ASSERT(dispatchSuccessful);
 }
 
+void AckLayer::releaseBusy() {
+    IDSMEMessage* next = nullptr;
+    DSME_ATOMIC_BLOCK {
+        if(this->rxQueue.isEmpty()) {
+            this->busy = false;
+        } else {
+            /* '-> stay busy and handle the next reception */
+            next = *this->rxQueue.front();
+            this->rxQueue.pop();
+        }
+    }
+
+    if(next != nullptr) {
+        DSME_ASSERT(this->pendingMessage == nullptr);
+        this->pendingMessage = next;
+        this->handlingQueuedReception = true;
+        bool dispatchSuccessful = dispatch(AckEvent::RECEIVE_REQUEST);
+        DSME_ASSERT(dispatchSuccessful);
+    }
+}
+
+bool AckLayer::isAckDeadlineMissed(IDSMEMessage* msg) {
+    /* the sender waits macAckWaitDuration after the end of its frame for the complete ACK (SHR, PHR and 5 octets)
+     * for an enhanced ACK, the wait and the ACK are both longer by the IE, so the latest start is the same */
+    PHY_PIB& phy_pib = this->dsme.getPHY_PIB();
+    uint32_t ackSymbols = phy_pib.phySHRDuration + 6 * phy_pib.phySymbolsPerOctet;
+    uint32_t endOfFrame = msg->getStartOfFrameDelimiterSymbolCounter() + phy_pib.phySymbolsPerOctet + msg->getMPDUSymbols();
+    uint32_t latestAckStart = endOfFrame + this->dsme.getMAC_PIB().helper.getAckWaitDuration() - ackSymbols;
+    return (int32_t)(this->dsme.getPlatform().getSymbolCounter() - latestAckStart) > 0;
+}
+
 //////////////////////////////// STATES ////////////////////////////////
 
 fsmReturnStatus AckLayer::catchAll(AckEvent& event) {
@@ -206,9 +321,7 @@ fsmReturnStatus AckLayer::catchAll(AckEvent& event) {
 fsmReturnStatus AckLayer::stateIdle(AckEvent& event) {
     switch(event.signal) {
         case AckEvent::ENTRY_SIGNAL:
-            DSME_ATOMIC_BLOCK {
-                this->busy = false;
-            }
+            releaseBusy();
             return FSM_HANDLED;
 
         case AckEvent::RESET:
@@ -228,69 +341,73 @@ fsmReturnStatus AckLayer::stateIdle(AckEvent& event) {
             } else {
                 /* '-> currently busy (e.g. recent reception) */
                 signalResult(SEND_FAILED);
-                DSME_ATOMIC_BLOCK {
-                    this->busy = false;
-                }
+                releaseBusy();
                 return FSM_HANDLED;
             }
         }
 
         case AckEvent::RECEIVE_REQUEST:
-            if(!dsme.getPlatform().isReceptionFromAckLayerPossible()) {
+            if(!isReceptionPossible()) {
                 dsme.getPlatform().releaseMessage(pendingMessage);
                 pendingMessage = nullptr;
-                DSME_ATOMIC_BLOCK {
-                    this->busy = false;
-                }
+                releaseBusy();
                 return FSM_HANDLED;
             }
 
             // according to 5.2.1.1.4, the ACK shall be sent anyway even with broadcast address, but this can not work for GTS replies (where the AR bit has to
             // be set 5.3.11.5.2)
             if(pendingMessage->getHeader().isAckRequested() && !pendingMessage->getHeader().getDestAddr().isBroadcast()) {
+                if(this->handlingQueuedReception && isAckDeadlineMissed(pendingMessage)) {
+                    /* '-> the sender already gave up and will retransmit, a late ACK would only interfere */
+                    LOG_DEBUG("Throwing away queued packet, ACK deadline missed.");
+                    this->numRxAckDeadlineMissed++;
+                    dsme.getPlatform().releaseMessage(pendingMessage);
+                    pendingMessage = nullptr;
+                    releaseBusy();
+                    return FSM_HANDLED;
+                }
+
                 LOG_DEBUG("sending ACK");
 
                 // keep the received message and set up the acknowledgement as new pending message
                 IDSMEMessage* receivedMessage = pendingMessage;
-                pendingMessage = dsme.getPlatform().getEmptyMessage();
-                if(pendingMessage == nullptr) {
-                    DSME_ASSERT(false);
-                    DSME_ATOMIC_BLOCK {
-                        this->busy = false;
-                    }
-                    return FSM_HANDLED;
-                }
+                DSME_ASSERT(this->ackTemplate != nullptr);
+                pendingMessage = this->ackTemplate;
+                pendingMessage->getHeader().patchSequenceNumber(receivedMessage->getHeader().getSequenceNumber());
 
-                IEEE802154eMACHeader& ackHeader = pendingMessage->getHeader();
-                ackHeader.setFrameType(IEEE802154eMACHeader::ACKNOWLEDGEMENT);
-                ackHeader.setSequenceNumber(receivedMessage->getHeader().getSequenceNumber());
+                /* the ACK template is shared, so the frame version of the acknowledged frame is set for every ACK */
+                pendingMessage->getHeader().setFrameVersion(receivedMessage->getHeader().getFrameVersion());
 
-                ackHeader.setDstAddr(receivedMessage->getHeader().getSrcAddr()); // TODO remove, this is only for the sequence diagram
+                /* a device sending a DATA-REQUEST keeps its receiver on only if a frame is pending for it */
+                pendingMessage->getHeader().setFramePending(dsme.getMessageDispatcher().hasIndirectFramesFor(receivedMessage));
+
+                /* enhanced ACK with the arrival time of a GTS frame, so the sender can resynchronize */
+                int16_t timeCorrection;
+                if(receivedMessage->getHeader().isVersion2015() && dsme.getMessageDispatcher().getTimeCorrection(receivedMessage, timeCorrection)) {
+                    pendingMessage->getHeader().setTimeCorrection(timeCorrection, false);
+                } else {
+                    pendingMessage->getHeader().clearTimeCorrection();
+                }
 
                 /* platform has to handle delaying the ACK to obey aTurnaroundTime */
                 bool success = dsme.getPlatform().sendDelayedAck(pendingMessage, receivedMessage, internalDoneCallback);
 
                 /* let upper layer handle the received message after the ACK has been transmitted */
-                dsme.getPlatform().handleReceivedMessageFromAckLayer(receivedMessage);
+                passReceivedMessageUp(receivedMessage);
 
                 if(success) {
                     return transition(&AckLayer::stateTxAck);
                 } else {
                     DSME_SIM_ASSERT(false);
 
-                    dsme.getPlatform().releaseMessage(pendingMessage);
-                    pendingMessage = nullptr;
-                    DSME_ATOMIC_BLOCK {
-                        this->busy = false;
-                    }
+                    pendingMessage = nullptr; // the ACK template is kept
+                    releaseBusy();
                     return FSM_HANDLED;
                 }
             } else {
-                dsme.getPlatform().handleReceivedMessageFromAckLayer(pendingMessage);
+                passReceivedMessageUp(pendingMessage);
                 pendingMessage = nullptr; // owned by upper layer now
-                DSME_ATOMIC_BLOCK {
-                    this->busy = false;
-                }
+                releaseBusy();
                 return FSM_HANDLED;
             }
 
@@ -356,11 +473,14 @@ fsmReturnStatus AckLayer::stateTx(AckEvent& event) {
 fsmReturnStatus AckLayer::stateWaitForAck(AckEvent& event) {
     switch(event.signal) {
         case AckEvent::ENTRY_SIGNAL:
-            this->dsme.getEventDispatcher().setupACKTimer();
+            this->dsme.getEventDispatcher().setupACKTimer(this->dsme.getMessageDispatcher().expectsEnhancedAck(pendingMessage));
             return FSM_HANDLED;
         case AckEvent::ACK_RECEIVED:
             if(event.seqNum == pendingMessage->getHeader().getSequenceNumber()) {
                 dsme.getEventDispatcher().stopACKTimer();
+                if(event.hasTimeCorrection) {
+                    dsme.getBeaconManager().handleTimeCorrection(pendingMessage->getHeader().getDestAddr(), event.timeCorrection);
+                }
                 signalResult(ACK_SUCCESSFUL);
                 return transition(&AckLayer::stateIdle);
             } else {
@@ -384,8 +504,8 @@ fsmReturnStatus AckLayer::stateWaitForAck(AckEvent& event) {
 fsmReturnStatus AckLayer::stateTxAck(AckEvent& event) {
     switch(event.signal) {
         case AckEvent::SEND_DONE:
-            dsme.getPlatform().releaseMessage(pendingMessage);
-            pendingMessage = nullptr;
+            DSME_ASSERT(pendingMessage == this->ackTemplate);
+            pendingMessage = nullptr; // the ACK template is kept
             return transition(&AckLayer::stateIdle);
 
         case AckEvent::RESET:
@@ -399,11 +519,8 @@ fsmReturnStatus AckLayer::stateTxAck(AckEvent& event) {
 fsmReturnStatus AckLayer::stateAbort(AckEvent& event) {
     switch(event.signal) {
         case AckEvent::SEND_DONE:
-            // external callback was already called if message was no ACK
-            if(pendingMessage) {
-                dsme.getPlatform().releaseMessage(pendingMessage);
-                pendingMessage = nullptr;
-            }
+            // external callback was already called if message was no ACK, the ACK template is kept
+            pendingMessage = nullptr;
             return transition(&AckLayer::stateIdle);
 
         default:
@@ -43,8 +43,22 @@
 #ifndef ACKLAYER_H_
 #define ACKLAYER_H_
 
+#include "../../../dsme_settings.h"
 #include "../../helper/DSMEBufferedFSM.h"
 #include "../../helper/DSMEDelegate.h"
+#include "../../helper/DSMELockFreeRingbuffer.h"
+#include "../../helper/DSMERingbuffer.h"
+#include "./AddressFilter.h"
+
+/* Number of received frames that are kept while the AckLayer is busy */
+#ifndef ACK_LAYER_RX_QUEUE_SIZE
+#define ACK_LAYER_RX_QUEUE_SIZE 4
+#endif
+
+/* Number of received frames passed up to the DSME layer that are not handled yet, only with DSME_LOCK_FREE_QUEUES */
+#ifndef ACK_LAYER_RX_HANDOFF_SIZE
+#define ACK_LAYER_RX_HANDOFF_SIZE 8
+#endif
 
 namespace dsme {
 
@@ -65,6 +79,14 @@ public:
     void fill(uint16_t signal, uint8_t seqNum) {
         this->signal = signal;
         this->seqNum = seqNum;
+        this->hasTimeCorrection = false;
+    }
+
+    void fill(uint16_t signal, uint8_t seqNum, int16_t timeCorrection) {
+        this->signal = signal;
+        this->seqNum = seqNum;
+        this->hasTimeCorrection = true;
+        this->timeCorrection = timeCorrection;
     }
 
     enum : uint8_t {
@@ -80,14 +102,17 @@ public:
 
     bool success;   // only valid for SEND_DONE
     uint8_t seqNum; // only valid for ACK_RECEIVED
+    bool hasTimeCorrection; // only valid for ACK_RECEIVED
+    int16_t timeCorrection; // only valid for ACK_RECEIVED with hasTimeCorrection, in microseconds
 };
 
-class AckLayer : private DSMEBufferedFSM<AckLayer, AckEvent, 2> {
+class AckLayer : private DSMEBufferedFSM<AckLayer, AckEvent, 3> {
 public:
     typedef Delegate<void(enum AckLayerResponse, IDSMEMessage* msg)> done_callback_t;
 
     explicit AckLayer(DSMELayer& dsme);
 
+    void initialize();
     void reset();
 
     /**
@@ -99,10 +124,44 @@ public:
     void abortPreparedTransmission();
 
     void sendAdditionalAck(uint8_t seqNum);
+
+    /**
+     * Can be called by the platform on the raw frame (starting with the frame control field) before a message is created for it.
+     * @return false, if the frame is not addressed to this device and can be discarded
+     */
+    bool isAddressedToMe(const uint8_t* frame, uint8_t length);
+
+    /**
+     * Has to be called after the extended address was changed, the other addresses are tracked automatically
+     */
+    void updateAddressFilter();
+
+    AddressFilter& getAddressFilter() {
+        return this->addressFilter;
+    }
+
     void receive(IDSMEMessage* msg);
     void dispatchTimer();
     bool ifMsgPending();
 
+#ifdef DSME_LOCK_FREE_QUEUES
+    /**
+     * Passes the received frames to the MessageDispatcher, called by the platform from the thread running the DSME layer
+     * after IDSMEPlatform::scheduleReceivedMessages
+     */
+    void processReceivedMessages();
+#endif
+
+    /* Received frames dropped because the receive queue was full */
+    uint32_t getNumRxQueueOverflows() const {
+        return this->numRxQueueOverflows;
+    }
+
+    /* Queued frames dropped because their acknowledgement could not be sent in time anymore */
+    uint32_t getNumRxAckDeadlineMissed() const {
+        return this->numRxAckDeadlineMissed;
+    }
+
 private:
     void sendDone(bool success);
     fsmReturnStatus stateIdle(AckEvent& event);
@@ -114,8 +173,22 @@ private:
 
     fsmReturnStatus catchAll(AckEvent& event);
 
+    /*
+     * Leaves the busy state, or continues with the next frame from the receive queue
+     */
+    void releaseBusy();
+    bool isAckDeadlineMissed(IDSMEMessage* msg);
+
+    /*
+     * Hand over of received frames to the DSME layer, decoupled from the radio interrupt
+     */
+    bool isReceptionPossible();
+    void passReceivedMessageUp(IDSMEMessage* msg);
+
     DSMELayer& dsme;
 
+    AddressFilter addressFilter;
+
     /*
      * Indicates if the layer is currently busy (i.e. in another state than idle)
      */
@@ -123,6 +196,27 @@ private:
 
     IDSMEMessage* pendingMessage{nullptr};
 
+    /*
+     * Immediate ACK that is reused for every reception, only the sequence number is patched
+     */
+    IDSMEMessage* ackTemplate{nullptr};
+
+    /*
+     * Frames received while busy, handled in order of reception once the layer becomes idle
+     */
+    DSMERingBuffer<IDSMEMessage*, ACK_LAYER_RX_QUEUE_SIZE> rxQueue;
+    bool handlingQueuedReception{false};
+
+#ifdef DSME_LOCK_FREE_QUEUES
+    /*
+     * Received frames passed up to the DSME layer, the AckLayer is the only producer and processReceivedMessages the only consumer
+     */
+    DSMESPSCRingBuffer<IDSMEMessage*, ACK_LAYER_RX_HANDOFF_SIZE> receivedMessages;
+#endif
+
+    uint32_t numRxQueueOverflows{0};
+    uint32_t numRxAckDeadlineMissed{0};
+
     done_callback_t externalDoneCallback;
 
     const Delegate<void(bool)> internalDoneCallback;
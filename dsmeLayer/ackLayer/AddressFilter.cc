@@ -0,0 +1,189 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "./AddressFilter.h"
+
+#include "../../mac_services/DSME_Common.h"
+#include "../../mac_services/pib/MAC_PIB.h"
+#include "../messages/IEEE802154eMACHeader.h"
+
+namespace dsme {
+
+AddressFilter::AddressFilter()
+    : panId(IEEE802154eMACHeader::BROADCAST_PAN),
+      shortAddress(IEEE802154MacAddress::SHORT_BROADCAST_ADDRESS),
+      filterPANId(false),
+      extendedAddress{},
+      multicastAddresses{},
+      numMulticastAddresses(0) {
+}
+
+void AddressFilter::update(const MAC_PIB& mac_pib) {
+    this->panId = mac_pib.macPANId;
+    this->shortAddress = mac_pib.macShortAddress;
+    this->filterPANId = mac_pib.macAssociatedPANCoord;
+
+    this->extendedMacAddress = mac_pib.macExtendedAddress;
+    uint8_t* buffer = this->extendedAddress;
+    buffer << this->extendedMacAddress;
+}
+
+bool AddressFilter::isOutdated(const MAC_PIB& mac_pib) const {
+    return this->panId != mac_pib.macPANId || this->shortAddress != mac_pib.macShortAddress || this->filterPANId != mac_pib.macAssociatedPANCoord;
+}
+
+bool AddressFilter::addMulticastAddress(uint16_t address) {
+    if(acceptShortAddress(address)) {
+        return true;
+    }
+    if(this->numMulticastAddresses >= ADDRESS_FILTER_MULTICAST_SIZE) {
+        return false;
+    }
+    this->multicastAddresses[this->numMulticastAddresses++] = address;
+    return true;
+}
+
+void AddressFilter::removeMulticastAddress(uint16_t address) {
+    for(uint8_t i = 0; i < this->numMulticastAddresses; i++) {
+        if(this->multicastAddresses[i] == address) {
+            this->multicastAddresses[i] = this->multicastAddresses[--this->numMulticastAddresses];
+            return;
+        }
+    }
+}
+
+bool AddressFilter::accept(const uint8_t* frame, uint8_t length) const {
+    if(length < 2) {
+        return false;
+    }
+
+    /* frame control, see IEEE 802.15.4-2015 7.2.1 */
+    uint8_t fcLow = frame[0];
+    uint8_t fcHigh = frame[1];
+
+    uint8_t frameType = fcLow & 0x07;
+    if(frameType == IEEE802154eMACHeader::BEACON || frameType == IEEE802154eMACHeader::ACKNOWLEDGEMENT) {
+        return true;
+    }
+
+    uint8_t dstAddrMode = (fcHigh >> 2) & 0x03;
+    if(dstAddrMode == NO_ADDRESS) {
+        return true;
+    }
+
+    uint8_t srcAddrMode = (fcHigh >> 6) & 0x03;
+    bool version2015 = ((fcHigh >> 4) & 0x03) == IEEE802154eMACHeader::IEEE802154_2015;
+
+    uint8_t offset = 2;
+    if(!(version2015 && (fcHigh & 0x01))) {
+        offset++; // sequence number
+    }
+
+    /* same rules as IEEE802154eMACHeader::setFrameControl for the presence of the destination PAN ID */
+    bool hasDstPAN = true;
+    if(version2015) {
+        bool compress = (fcLow >> 6) & 0x01;
+        bool shortAddr = (srcAddrMode == SHORT_ADDRESS || dstAddrMode == SHORT_ADDRESS);
+        hasDstPAN = !compress || (srcAddrMode != NO_ADDRESS && shortAddr);
+    }
+
+    if(hasDstPAN) {
+        if(offset + 2 > length) {
+            return false;
+        }
+        if(!acceptPANId(frame[offset] | (frame[offset + 1] << 8))) {
+            return false;
+        }
+        offset += 2;
+    }
+
+    if(dstAddrMode == SHORT_ADDRESS) {
+        if(offset + 2 > length) {
+            return false;
+        }
+        return acceptShortAddress(frame[offset] | (frame[offset + 1] << 8));
+    } else if(dstAddrMode == EXTENDED_ADDRESS) {
+        if(offset + 8 > length) {
+            return false;
+        }
+        for(uint8_t i = 0; i < 8; i++) {
+            if(frame[offset + i] != this->extendedAddress[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return true;
+}
+
+bool AddressFilter::accept(const IEEE802154eMACHeader& header) const {
+    if(header.hasDestinationPANId() && !acceptPANId(header.getDstPANId())) {
+        return false;
+    }
+
+    if(header.getDstAddrMode() == SHORT_ADDRESS) {
+        return acceptShortAddress(header.getDestAddr().getShortAddress());
+    } else if(header.getDstAddrMode() == EXTENDED_ADDRESS) {
+        return header.getDestAddr() == this->extendedMacAddress;
+    }
+
+    return true;
+}
+
+bool AddressFilter::acceptPANId(uint16_t panId) const {
+    return !this->filterPANId || panId == this->panId || panId == IEEE802154eMACHeader::BROADCAST_PAN;
+}
+
+bool AddressFilter::acceptShortAddress(uint16_t address) const {
+    if(address == this->shortAddress || address == IEEE802154MacAddress::SHORT_BROADCAST_ADDRESS) {
+        return true;
+    }
+    for(uint8_t i = 0; i < this->numMulticastAddresses; i++) {
+        if(this->multicastAddresses[i] == address) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} /* namespace dsme */
@@ -0,0 +1,109 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef ADDRESSFILTER_H_
+#define ADDRESSFILTER_H_
+
+#include "../../../dsme_settings.h"
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
+
+/* Number of additional short addresses (e.g. multicast groups) accepted by the address filter */
+#ifndef ADDRESS_FILTER_MULTICAST_SIZE
+#define ADDRESS_FILTER_MULTICAST_SIZE 4
+#endif
+
+namespace dsme {
+
+class MAC_PIB;
+class IEEE802154eMACHeader;
+
+/**
+ * Decides whether a received frame is addressed to this device, like the address filter of a transceiver.
+ * The own addresses are kept in their over-the-air representation, so a frame can be checked on its raw bytes
+ * before any header object is constructed.
+ */
+class AddressFilter {
+public:
+    AddressFilter();
+
+    /**
+     * Takes over PAN ID, short address and extended address from the PIB
+     */
+    void update(const MAC_PIB& mac_pib);
+
+    /**
+     * Returns whether the PAN ID, the short address or the association changed since the last update.
+     * The extended address is assumed to be constant after the initialization.
+     */
+    bool isOutdated(const MAC_PIB& mac_pib) const;
+
+    bool addMulticastAddress(uint16_t address);
+    void removeMulticastAddress(uint16_t address);
+
+    /**
+     * Checks a frame starting with the frame control field
+     */
+    bool accept(const uint8_t* frame, uint8_t length) const;
+
+    /**
+     * Checks an already deserialized header
+     */
+    bool accept(const IEEE802154eMACHeader& header) const;
+
+private:
+    bool acceptPANId(uint16_t panId) const;
+    bool acceptShortAddress(uint16_t address) const;
+
+    uint16_t panId;
+    uint16_t shortAddress;
+    bool filterPANId;
+    uint8_t extendedAddress[8];
+    IEEE802154MacAddress extendedMacAddress;
+
+    uint16_t multicastAddresses[ADDRESS_FILTER_MULTICAST_SIZE];
+    uint8_t numMulticastAddresses;
+};
+
+} /* namespace dsme */
+
+#endif /* ADDRESSFILTER_H_ */
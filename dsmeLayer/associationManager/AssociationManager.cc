@@ -52,6 +52,7 @@
 #include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
 #include "../../mac_services/pib/MAC_PIB.h"
 #include "../DSMELayer.h"
+#include "../gtsManager/GTSManager.h"
 #include "../messageDispatcher/MessageDispatcher.h"
 #include "../messages/DSMEAssociationRequestCmd.h"
 #include "../messages/DSMEAssociationResponseCmd.h"
@@ -93,6 +94,7 @@ void AssociationManager::sendAssociationRequest(DSMEAssociationRequestCmd& req,
     }
 
     messageSent = false;
+    requestedDirection = params.direction;
 
     IDSMEMessage* msg = dsme.getPlatform().getEmptyMessage();
     req.prependTo(msg);
@@ -123,7 +125,7 @@ void AssociationManager::sendAssociationRequest(DSMEAssociationRequestCmd& req,
 }
 
 void AssociationManager::handleAssociationRequest(IDSMEMessage* msg) {
-    DSMEAssociationRequestCmd req;
+    DSMEAssociationRequestCmd req(this->dsme.getMAC_PIB().macAssociationGTSAllocation);
     req.decapsulateFrom(msg);
 
     mlme_sap::ASSOCIATE_indication_parameters params;
@@ -132,11 +134,13 @@ void AssociationManager::handleAssociationRequest(IDSMEMessage* msg) {
     params.channelOffset = req.getChannelOffset();
     params.hoppingSequenceId = req.getHoppingSequenceId();
     params.hoppingSequenceRequest = req.getHoppingSequenceId() == 1;
+    params.dsmeAssociation = req.isDsmeAssociation();
+    params.direction = req.getDirection();
 
     this->dsme.getMLME_SAP().getASSOCIATE().notify_indication(params);
 }
 
-void AssociationManager::sendAssociationReply(DSMEAssociationResponseCmd& response, IEEE802154MacAddress& deviceAddress) {
+void AssociationManager::sendAssociationReply(DSMEAssociationResponseCmd& response, IEEE802154MacAddress& deviceAddress, Direction direction) {
     DSME_ATOMIC_BLOCK {
         if(this->actionPending) {
             return;
@@ -149,6 +153,29 @@ void AssociationManager::sendAssociationReply(DSMEAssociationResponseCmd& respon
 
     LOG_INFO("Replying to association request from " << deviceAddress.getShortAddress() << ".");
 
+    if(response.isDsmeAssociation()) {
+        DSMEAllocationCounterTable& act = this->dsme.getMAC_PIB().macDSMEACT;
+        if(response.getStatus() != AssociationStatus::SUCCESS || act.isAllocated(response.getSuperframeId(), response.getSlotId())) {
+            /* '-> the slot was taken in the meantime, the device has to negotiate a GTS on its own */
+            response.clearDsmeAssociation();
+        } else {
+            /* The slot is added right away so it cannot be given away twice, it is removed again if the response is not acknowledged.
+             * Not UNCONFIRMED, since the GTSManager would expire it at the next CFP if the response is still queued. */
+            Direction ownDirection = (direction == TX) ? RX : TX;
+            act.add(response.getSuperframeId(), response.getSlotId(), response.getChannelIdx(), ownDirection, response.getShortAddr(), VALID);
+            DSMESABSpecification sabSpec;
+            getAssociationSABSpecification(sabSpec, response.getSuperframeId(), response.getSlotId(), response.getChannelIdx());
+            this->dsme.getMAC_PIB().macDSMESAB.addOccupiedSlots(sabSpec);
+            this->allocationPending = true;
+            this->allocationDeviceAddress = deviceAddress;
+            this->allocationShortAddress = response.getShortAddr();
+            this->allocationDirection = direction;
+            this->allocationSuperframeId = response.getSuperframeId();
+            this->allocationSlotId = response.getSlotId();
+            this->allocationChannelIdx = response.getChannelIdx();
+        }
+    }
+
     IDSMEMessage* msg = dsme.getPlatform().getEmptyMessage();
     response.prependTo(msg);
     MACCommand cmd;
@@ -168,12 +195,73 @@ void AssociationManager::sendAssociationReply(DSMEAssociationResponseCmd& respon
 
     if(!dsme.getMessageDispatcher().sendInCAP(msg)) {
         // TODO
+        finishPendingAllocation(false);
         dsme.getPlatform().releaseMessage(msg);
     }
     return;
 }
 
+void AssociationManager::finishPendingAllocation(bool success) {
+    if(!this->allocationPending) {
+        return;
+    }
+    this->allocationPending = false;
+
+    if(success) {
+        /* '-> like the receipt of the DSME-GTS notify at the end of a regular allocation */
+        mlme_sap::COMM_STATUS_indication_parameters params;
+        params.panId = this->dsme.getMAC_PIB().macPANId;
+        params.srcAddrMode = AddrMode::EXTENDED_ADDRESS;
+        params.srcAddr = this->dsme.getMAC_PIB().macExtendedAddress;
+        params.dstAddrMode = AddrMode::EXTENDED_ADDRESS;
+        params.dstAddr = this->allocationDeviceAddress;
+        params.status = CommStatus::SUCCESS;
+        this->dsme.getMLME_SAP().getCOMM_STATUS().notify_indication(params);
+
+        /* '-> the response was not broadcast like a DSME GTS reply, so the neighbors are notified separately */
+        DSMESABSpecification sabSpec;
+        getAssociationSABSpecification(sabSpec, this->allocationSuperframeId, this->allocationSlotId, this->allocationChannelIdx);
+        this->dsme.getGTSManager().sendAllocationNotify(this->allocationShortAddress, this->allocationDirection, sabSpec);
+        return;
+    }
+
+    DSMEAllocationCounterTable& act = this->dsme.getMAC_PIB().macDSMEACT;
+    DSMEAllocationCounterTable::iterator it = act.find(this->allocationSuperframeId, this->allocationSlotId);
+    if(it != act.end()) {
+        LOG_INFO("Association response not delivered, removing the GTS allocated with it.");
+        act.remove(it);
+    }
+
+    DSMESABSpecification sabSpec;
+    getAssociationSABSpecification(sabSpec, this->allocationSuperframeId, this->allocationSlotId, this->allocationChannelIdx);
+    this->dsme.getMAC_PIB().macDSMESAB.removeOccupiedSlots(sabSpec);
+}
+
+void AssociationManager::getAssociationSABSpecification(DSMESABSpecification& sabSpec, uint16_t superframeId, uint8_t slotId, uint16_t channelIdx) {
+    uint8_t numChannels = this->dsme.getMAC_PIB().helper.getNumChannels();
+    sabSpec.setSubBlockLengthBytes(this->dsme.getMAC_PIB().helper.getSubBlockLengthBytes(superframeId));
+    sabSpec.setSubBlockIndex(superframeId);
+    sabSpec.getSubBlock().fill(false);
+    sabSpec.getSubBlock().set(slotId * numChannels + channelIdx, true);
+}
+
+bool AssociationManager::isValidAssociationGTS(DSMEAssociationResponseCmd& response) {
+    /* WARNING this is safety and security relevant, because the values stem from incoming message content */
+    PIBHelper& helper = this->dsme.getMAC_PIB().helper;
+    return response.getSuperframeId() < helper.getNumberSuperframesPerMultiSuperframe() && response.getSlotId() < helper.getNumGTSlots(response.getSuperframeId()) &&
+           response.getChannelIdx() < helper.getNumChannels();
+}
+
 void AssociationManager::handleAssociationReply(IDSMEMessage* msg) {
+    DSMEAssociationResponseCmd response(this->dsme.getMAC_PIB().macChannelDiversityMode, this->dsme.getMAC_PIB().macAssociationGTSAllocation);
+    response.decapsulateFrom(msg);
+
+    if(response.isDsmeAssociation() && !isValidAssociationGTS(response)) {
+        /* '-> treated like a missing response, the association request times out */
+        LOG_ERROR("Invalid GTS in association response");
+        return;
+    }
+
     DSME_ATOMIC_BLOCK {
         if(!this->actionPending || this->currentAction != CommandFrameIdentifier::ASSOCIATION_REQUEST) {
             // No association pending, for example because of an ACK timeout
@@ -183,13 +271,29 @@ void AssociationManager::handleAssociationReply(IDSMEMessage* msg) {
         this->messageSent = false;
     }
 
-    DSMEAssociationResponseCmd response(this->dsme.getMAC_PIB().macChannelDiversityMode);
-    response.decapsulateFrom(msg);
-
     mlme_sap::ASSOCIATE_confirm_parameters params;
     params.assocShortAddress = response.getShortAddr();
     params.status = response.getStatus();
 
+    uint16_t coordAddress = msg->getHeader().getSrcAddr().getShortAddress();
+    DSMESABSpecification sabSpec;
+    bool gtsAllocated = false;
+    if(response.isDsmeAssociation() && params.status == AssociationStatus::SUCCESS) {
+        /* '-> fast join, the coordinator already allocated a GTS for us */
+        DSMEAllocationCounterTable& act = this->dsme.getMAC_PIB().macDSMEACT;
+        if(!act.isAllocated(response.getSuperframeId(), response.getSlotId())) {
+            act.add(response.getSuperframeId(), response.getSlotId(), response.getChannelIdx(), this->requestedDirection, coordAddress, VALID);
+            getAssociationSABSpecification(sabSpec, response.getSuperframeId(), response.getSlotId(), response.getChannelIdx());
+            this->dsme.getMAC_PIB().macDSMESAB.addOccupiedSlots(sabSpec);
+            gtsAllocated = true;
+
+            params.dsmeAssociation = true;
+            params.superframeId = response.getSuperframeId();
+            params.slotId = response.getSlotId();
+            params.channelIndex = response.getChannelIdx();
+        }
+    }
+
     this->dsme.getMLME_SAP().getASSOCIATE().notify_confirm(params);
 
     if((params.status == AssociationStatus::SUCCESS) || (params.status == AssociationStatus::FASTA_SUCCESSFUL)) {
@@ -200,6 +304,22 @@ void AssociationManager::handleAssociationReply(IDSMEMessage* msg) {
         // Do not start tracking beacons, this is done in SYNC!
 
         this->dsme.getPlatform().updateVisual();
+
+        if(gtsAllocated) {
+            /* '-> reported like the reply to a regular allocation request */
+            mlme_sap::DSME_GTS_confirm_parameters gtsParams;
+            gtsParams.deviceAddress = coordAddress;
+            gtsParams.managementType = ManagementType::ALLOCATION;
+            gtsParams.direction = this->requestedDirection;
+            gtsParams.prioritizedChannelAccess = Priority::LOW;
+            gtsParams.channelOffset = 0;
+            gtsParams.dsmeSabSpecification = sabSpec;
+            gtsParams.status = GTSStatus::SUCCESS;
+            this->dsme.getMLME_SAP().getDSME_GTS().notify_confirm(gtsParams);
+
+            /* '-> like the requesting device at the end of a regular allocation, now with the assigned short address */
+            this->dsme.getGTSManager().sendAllocationNotify(coordAddress, this->requestedDirection, sabSpec);
+        }
     } else {
         /* default in case of failure */
         this->dsme.getMAC_PIB().macPANId = 0xffff;
@@ -288,6 +408,7 @@ void AssociationManager::onCSMASent(IDSMEMessage* msg, CommandFrameIdentifier cm
         DSME_ASSERT(this->currentAction == cmdId);
 
         if(cmdId == CommandFrameIdentifier::ASSOCIATION_RESPONSE) {
+            finishPendingAllocation(status == DataStatus::Data_Status::SUCCESS);
             this->actionPending = false;
             this->messageSent = false;
             this->superframesSinceAssociationSent = 0;
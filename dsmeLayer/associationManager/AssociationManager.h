@@ -74,7 +74,7 @@ public:
 
     void sendAssociationRequest(DSMEAssociationRequestCmd& associateRequestCmd, mlme_sap::ASSOCIATE::request_parameters& params);
     void handleAssociationRequest(IDSMEMessage* msg);
-    void sendAssociationReply(DSMEAssociationResponseCmd& response, IEEE802154MacAddress& deviceAddress);
+    void sendAssociationReply(DSMEAssociationResponseCmd& response, IEEE802154MacAddress& deviceAddress, Direction direction);
     void handleAssociationReply(IDSMEMessage* msg);
 
     void sendDisassociationRequest(DisassociationNotifyCmd& req, mlme_sap::DISASSOCIATE::request_parameters& params);
@@ -96,6 +96,28 @@ private:
     CommandFrameIdentifier currentAction;
 
     uint8_t superframesSinceAssociationSent;
+
+    /* GTS allocated together with the association (fast join) */
+    Direction requestedDirection = TX;
+    bool allocationPending = false;
+    uint16_t allocationSuperframeId = 0;
+    uint8_t allocationSlotId = 0;
+    uint16_t allocationChannelIdx = 0;
+    IEEE802154MacAddress allocationDeviceAddress;
+    uint16_t allocationShortAddress = 0;
+    Direction allocationDirection = TX; // as seen from the device
+
+    /**
+     * Keep and announce or remove the GTS allocated by the coordinator once the association response was sent
+     */
+    void finishPendingAllocation(bool success);
+
+    void getAssociationSABSpecification(DSMESABSpecification& sabSpec, uint16_t superframeId, uint8_t slotId, uint16_t channelIdx);
+
+    /**
+     * Checks that the GTS of a received association response fits into the slot structure
+     */
+    bool isValidAssociationGTS(DSMEAssociationResponseCmd& response);
 };
 
 } /* namespace dsme */
@@ -0,0 +1,138 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef BEACONIMAGE_H_
+#define BEACONIMAGE_H_
+
+#include "../../../dsme_platform.h"
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/BeaconBitmap.h"
+#include "../../mac_services/dataStructures/DSMEMessageElement.h"
+#include "../../mac_services/dataStructures/DSMEPANDescriptor.h"
+#include "../../mac_services/dataStructures/Serializer.h"
+#include "../../mac_services/dataStructures/TimeSyncSpecification.h"
+#include "../../mac_services/pib/dsme_phy_constants.h"
+
+namespace dsme {
+
+/**
+ * Pre-serialized DSME PAN descriptor of the own enhanced beacon.
+ * The image is only rebuilt if a component of the descriptor changed, otherwise
+ * just the time synchronization specification and the beacon bitmap are patched in place.
+ */
+class BeaconImage : public DSMEMessageElement {
+public:
+    BeaconImage() : valid(false), length(0), timeSyncOffset(0), beaconBitmapOffset(0), beaconBitmapLength(0) {
+    }
+
+    bool isValid() const {
+        return valid;
+    }
+
+    /**
+     * Has to be called whenever a component of the PAN descriptor is modified
+     */
+    void invalidate() {
+        valid = false;
+    }
+
+    void build(DSMEPANDescriptor& descr) {
+        length = descr.getSerializationLength();
+        DSME_ASSERT(length <= aMaxPHYPacketSize);
+
+        /* superframe specification, pending addresses and DSME superframe specification precede the time sync specification */
+        timeSyncOffset = 2 + descr.pendingAddresses.getSerializationLength() + 1;
+        beaconBitmapOffset = timeSyncOffset + 8;
+        beaconBitmapLength = descr.getBeaconBitmap().getSerializationLength();
+
+        Serializer serializer(image, SERIALIZATION);
+        descr.serialize(serializer);
+        valid = true;
+    }
+
+    void patchTimeSyncSpec(TimeSyncSpecification& timeSyncSpec) {
+        DSME_ASSERT(valid);
+        Serializer serializer(image + timeSyncOffset, SERIALIZATION);
+        serializer << timeSyncSpec;
+    }
+
+    /**
+     * Writes the given bits and SD index into the beacon bitmap of the image.
+     * @return false if the length of the bitmap changed, the image has to be rebuilt then
+     */
+    bool patchBeaconBitmap(uint16_t sdIndex, BeaconBitmap& sdBitmap) {
+        if(!valid || sdBitmap.getSerializationLength() != beaconBitmapLength) {
+            return false;
+        }
+
+        Serializer serializer(image + beaconBitmapOffset, SERIALIZATION);
+        serializer << sdBitmap;
+
+        /* the SD index of the given bitmap is not the one of this device */
+        Serializer indexSerializer(image + beaconBitmapOffset, SERIALIZATION);
+        indexSerializer << sdIndex;
+        return true;
+    }
+
+    virtual uint8_t getSerializationLength() {
+        return length;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        DSME_ASSERT(valid && serializer.getType() == SERIALIZATION);
+        for(uint8_t i = 0; i < length; i++) {
+            serializer << image[i];
+        }
+    }
+
+private:
+    bool valid;
+    uint8_t length;
+    uint8_t timeSyncOffset;
+    uint8_t beaconBitmapOffset;
+    uint8_t beaconBitmapLength;
+    uint8_t image[aMaxPHYPacketSize];
+};
+
+} /* namespace dsme */
+
+#endif /* BEACONIMAGE_H_ */
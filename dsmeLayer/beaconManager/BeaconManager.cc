@@ -54,6 +54,7 @@
 #include "../../mac_services/dataStructures/TimeSyncSpecification.h"
 #include "../../mac_services/mlme_sap/BEACON_NOTIFY.h"
 #include "../../mac_services/mlme_sap/MLME_SAP.h"
+#include "../../mac_services/mlme_sap/POLL.h"
 #include "../../mac_services/mlme_sap/SCAN.h"
 #include "../../mac_services/mlme_sap/SYNC_LOSS.h"
 #include "../../mac_services/pib/MAC_PIB.h"
@@ -61,6 +62,8 @@
 #include "../../mac_services/pib/dsme_mac_constants.h"
 #include "../../mac_services/pib/dsme_phy_constants.h"
 #include "../DSMELayer.h"
+#include "../capLayer/CAPLayer.h"
+#include "../gtsManager/GTSManager.h"
 #include "../messageDispatcher/MessageDispatcher.h"
 #include "../messages/BeaconNotificationCmd.h"
 #include "../messages/IEEE802154eMACHeader.h"
@@ -77,6 +80,18 @@ BeaconManager::BeaconManager(DSMELayer& dsme)
 
       numBeaconCollision(0),
       missedBeacons(0),
+      clockDrift(0),
+      syncErrorSymbols(0),
+      driftReferenceStart(0),
+      driftReferenceParent(0),
+      driftReferenceValid(false),
+      lastTimeCorrection(0),
+      idleMultiSuperframes(0),
+      capReductionCountdown(0),
+      beaconCCAPending(false),
+      beaconDeferrals(0),
+      beaconSlotTime(0),
+      beaconSymbols(0),
       doneCallback(DELEGATE(&BeaconManager::sendDone, *this)),
 
       currentScanChannel(0),
@@ -121,6 +136,9 @@ void BeaconManager::initialize() {
     dsmePANDescriptor.superframeSpec.reserved = 0;
     dsmePANDescriptor.superframeSpec.PANCoordinator = dsme.getMAC_PIB().macIsPANCoord;
     dsmePANDescriptor.superframeSpec.associationPermit = 1;
+    dsmePANDescriptor.dsmeSuperframeSpec.CAPReductionFlag = dsme.getMAC_PIB().macCapReduction;
+    dsmePANDescriptor.dsmeSuperframeSpec.deferredBeaconFlag = dsme.getMAC_PIB().macDeferredBeaconUsed;
+    beaconImage.invalidate();
 
     lastKnownBeaconIntervalStart = dsme.getPlatform().getSymbolCounter();
 }
@@ -129,6 +147,12 @@ void BeaconManager::reset() {
     isBeaconAllocated = false;
     isBeaconAllocationSent = false;
     missedBeacons = 0;
+    resetClockDrift();
+    idleMultiSuperframes = 0;
+    capReductionCountdown = 0;
+    dsmePANDescriptor.dsmeSuperframeSpec.CAPReductionFlag = dsme.getMAC_PIB().macCapReduction;
+    beaconCCAPending = false;
+    beaconDeferrals = 0;
 
     if(dsme.getMAC_PIB().macIsPANCoord) {
         dsmePANDescriptor.getBeaconBitmap().setSDIndex(0);
@@ -137,6 +161,7 @@ void BeaconManager::reset() {
     } else if(dsme.getMAC_PIB().macIsCoord) {
         dsmePANDescriptor.getBeaconBitmap().fill(false);
     }
+    beaconImage.invalidate();
 
     this->dsme.getMAC_PIB().macSdBitmap.fill(false);
     this->neighborOrOwnHeardBeacons.fill(false);
@@ -145,13 +170,20 @@ void BeaconManager::reset() {
 void BeaconManager::preSuperframeEvent(uint16_t nextSuperframe, uint16_t nextMultiSuperframe, uint32_t startSlotTime) {
     uint16_t nextSDIndex = nextSuperframe + this->dsme.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe() * nextMultiSuperframe;
 
-    if((this->isBeaconAllocated || this->dsme.getMAC_PIB().macIsPANCoord) && nextSDIndex == this->dsmePANDescriptor.getBeaconBitmap().getSDIndex()) {
+    if(nextSDIndex == 0 && this->capReductionCountdown > 0 && --this->capReductionCountdown == 0) {
+        /* '-> switch at the start of the beacon interval before the CAP of the first superframe */
+        this->dsme.getGTSManager().setCapReduction(dsmePANDescriptor.dsmeSuperframeSpec.CAPReductionFlag);
+    }
+
+    if((this->isBeaconAllocated || this->dsme.getMAC_PIB().macIsPANCoord) && !this->dsme.isResumePending() &&
+       nextSDIndex == this->dsmePANDescriptor.getBeaconBitmap().getSDIndex()) {
         // This node will transmit a beacon
         this->dsme.getPlatform().turnTransceiverOn();
         this->dsme.getPlatform().setChannelNumber(this->dsme.getPHY_PIB().phyCurrentChannel);
-        prepareEnhancedBeacon(startSlotTime);
-    } else if((!dsme.getMAC_PIB().macAssociatedPANCoord) || nextSDIndex == this->dsme.getMAC_PIB().macSyncParentSdIndex) {
-        // This node expects a beacon, only if not associated or a beacon from the SYNC-parent is expected
+        /* with deferred beacons, the transmission only starts after the CCA at the slot boundary */
+        prepareEnhancedBeacon(startSlotTime, dsme.getMAC_PIB().macDeferredBeaconUsed ? aCcaTime : 0);
+    } else if((!dsme.getMAC_PIB().macAssociatedPANCoord) || this->dsme.isResumePending() || nextSDIndex == this->dsme.getMAC_PIB().macSyncParentSdIndex) {
+        // This node expects a beacon, only if not associated, not yet synchronized after a restart or a beacon from the SYNC-parent is expected
         this->dsme.getPlatform().turnTransceiverOn();
         this->dsme.getPlatform().setChannelNumber(this->dsme.getPHY_PIB().phyCurrentChannel);
     } else {
@@ -164,6 +196,10 @@ void BeaconManager::superframeEvent(int32_t lateness, uint32_t currentSlotTime)
         if(lateness > 1) {
             dsme.getAckLayer().abortPreparedTransmission();
             LOG_ERROR("Beacon aborted");
+        } else if(dsme.getMAC_PIB().macDeferredBeaconUsed) {
+            beaconDeferrals = 0;
+            beaconSlotTime = currentSlotTime;
+            startBeaconCCA();
         } else {
             dsme.getAckLayer().sendNowIfPending();
         }
@@ -174,14 +210,86 @@ void BeaconManager::superframeEvent(int32_t lateness, uint32_t currentSlotTime)
     }
 }
 
-void BeaconManager::prepareEnhancedBeacon(uint32_t nextSlotTime) {
+void BeaconManager::startBeaconCCA() {
+    beaconCCAPending = true;
+    if(!dsme.getPlatform().startCCA()) {
+        handleBeaconCCAResult(false);
+    }
+}
+
+void BeaconManager::handleBeaconCCAResult(bool success) {
+    beaconCCAPending = false;
+    if(!transmissionPending) {
+        /* '-> aborted in the meantime, e.g. by a reset */
+        return;
+    }
+
+    if(success) {
+        dsme.getAckLayer().sendNowIfPending();
+        return;
+    }
+
+    dsme.getAckLayer().abortPreparedTransmission();
+    if(!deferBeacon()) {
+        LOG_ERROR("Beacon skipped, channel busy");
+    }
+}
+
+bool BeaconManager::deferBeacon() {
+    if(beaconDeferrals >= DEFERRED_BEACON_MAX_DEFERRALS) {
+        return false;
+    }
+    beaconDeferrals++;
+
+    /* like the CSMA backoff, the window grows with every deferral */
+    uint8_t backoffExponent = dsme.getMAC_PIB().macMinBE + beaconDeferrals - 1;
+    if(backoffExponent > dsme.getMAC_PIB().macMaxBE) {
+        backoffExponent = dsme.getMAC_PIB().macMaxBE;
+    }
+    uint16_t backoffPeriods = 1 + dsme.getPlatform().getRandom() % (1 << backoffExponent);
+
+    uint32_t now = dsme.getPlatform().getSymbolCounter();
+    uint32_t offset = now - beaconSlotTime + aCcaTime + backoffPeriods * aUnitBackoffPeriod;
+
+    /* the beacon has to be completed before the pre-event of the first CAP slot and the offset is transmitted in microseconds */
+    if(offset + beaconSymbols + PRE_EVENT_SHIFT > dsme.getMAC_PIB().helper.getSymbolsPerSlot() || offset * aSymbolDuration > UINT16_MAX) {
+        return false;
+    }
+
+    prepareEnhancedBeacon(beaconSlotTime, offset);
+    if(!transmissionPending) {
+        return false;
+    }
+    LOG_DEBUG("Beacon deferred by " << offset << " symbols");
+    dsme.getEventDispatcher().setupBeaconTimer(beaconSlotTime + offset - aCcaTime);
+    return true;
+}
+
+void BeaconManager::handleBeaconTimer() {
+    if(transmissionPending) {
+        startBeaconCCA();
+    }
+}
+
+void BeaconManager::prepareEnhancedBeacon(uint32_t nextSlotTime, uint16_t beaconOffset) {
     DSME_ASSERT(!transmissionPending);
     IDSMEMessage* msg = dsme.getPlatform().getEmptyMessage();
 
     dsmePANDescriptor.getTimeSyncSpec().setBeaconTimestampMicroSeconds(nextSlotTime * aSymbolDuration);
-    dsmePANDescriptor.getTimeSyncSpec().setBeaconOffsetTimestampMicroSeconds(0);
-    dsmePANDescriptor.getBeaconBitmap().copyBitsFrom(this->dsme.getMAC_PIB().macSdBitmap);
-    dsmePANDescriptor.prependTo(msg); // TODO this should be implemented as IE
+    dsmePANDescriptor.getTimeSyncSpec().setBeaconOffsetTimestampMicroSeconds(beaconOffset * aSymbolDuration);
+
+    /* Advertise the destinations of indirect transmissions, their number changes the layout of the image */
+    if(dsme.getMessageDispatcher().updatePendingAddresses(dsmePANDescriptor.pendingAddresses)) {
+        beaconImage.invalidate();
+    }
+
+    /* Only serialize the whole descriptor if it changed, otherwise patch the cached image */
+    if(!beaconImage.patchBeaconBitmap(dsmePANDescriptor.getBeaconBitmap().getSDIndex(), this->dsme.getMAC_PIB().macSdBitmap)) {
+        dsmePANDescriptor.getBeaconBitmap().copyBitsFrom(this->dsme.getMAC_PIB().macSdBitmap);
+        beaconImage.build(dsmePANDescriptor);
+    }
+    beaconImage.patchTimeSyncSpec(dsmePANDescriptor.getTimeSyncSpec());
+    beaconImage.prependTo(msg); // TODO this should be implemented as IE
 
     msg->getHeader().setDstAddr(IEEE802154MacAddress(IEEE802154MacAddress::SHORT_BROADCAST_ADDRESS));
     msg->getHeader().setDstAddrMode(SHORT_ADDRESS);
@@ -192,10 +300,12 @@ void BeaconManager::prepareEnhancedBeacon(uint32_t nextSlotTime) {
     msg->getHeader().setSrcPANId(this->dsme.getMAC_PIB().macPANId);
     msg->getHeader().setDstPANId(this->dsme.getMAC_PIB().macPANId);
 
+    beaconSymbols = msg->getTotalSymbols();
     transmissionPending = true;
     if(!dsme.getAckLayer().prepareSendingCopy(msg, doneCallback)) {
         // message could not be sent
         LOG_DEBUG("Beacon could not be sent");
+        transmissionPending = false;
         dsme.getPlatform().releaseMessage(msg);
     } else {
         LOG_DEBUG("Beacon sent");
@@ -256,7 +366,7 @@ void BeaconManager::printBeaconStatistics() {
 }
 #endif
 
-bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& descr) {
+bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, const BeaconView& beacon) {
 #ifdef STATISTICS_BEACONS
     DSME_ATOMIC_BLOCK {
         statsIdx = (statsIdx + 1) % STATS_NUM;
@@ -265,7 +375,7 @@ bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& d
         stat.sender = msg->getHeader().getSrcAddr().getShortAddress();
         stat.lqi = msg->getLQI();
         stat.rssi = msg->getRSSI();
-        stat.sdIndex = descr.getBeaconBitmap().getSDIndex();
+        stat.sdIndex = beacon.getSDIndex();
         if(statsValid < STATS_NUM) {
             statsValid++;
         }
@@ -283,17 +393,20 @@ bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& d
         return false;
     }
 
-    LOG_DEBUG("Updating heard Beacons, index is " << descr.getBeaconBitmap().getSDIndex() << ".");
-    this->dsme.getMAC_PIB().macSdIndex = descr.getBeaconBitmap().getSDIndex();
-    this->dsme.getMAC_PIB().macSdBitmap.set(descr.getBeaconBitmap().getSDIndex(), true);
-    neighborOrOwnHeardBeacons.set(descr.getBeaconBitmap().getSDIndex(), true);
-    neighborOrOwnHeardBeacons.orWith(descr.getBeaconBitmap());
+    LOG_DEBUG("Updating heard Beacons, index is " << beacon.getSDIndex() << ".");
+    this->dsme.getMAC_PIB().macSdIndex = beacon.getSDIndex();
+    this->dsme.getMAC_PIB().macSdBitmap.set(beacon.getSDIndex(), true);
+    neighborOrOwnHeardBeacons.set(beacon.getSDIndex(), true);
+    neighborOrOwnHeardBeacons.orWith(beacon.getSDBitmap(), beacon.getSDBitmapLengthBytes());
 
     /* Update channel offset bitmap and channel offset if another neighbor already uses it */
     if(this->dsme.getMAC_PIB().macChannelDiversityMode == Channel_Diversity_Mode::CHANNEL_HOPPING) {
-        dsmePANDescriptor.channelHoppingSpecification.getChannelOffsetBitmap().set(descr.channelHoppingSpecification.getChannelOffset(), 1);
+        if(!dsmePANDescriptor.channelHoppingSpecification.getChannelOffsetBitmap().get(beacon.getChannelOffset())) {
+            dsmePANDescriptor.channelHoppingSpecification.getChannelOffsetBitmap().set(beacon.getChannelOffset(), 1);
+            beaconImage.invalidate();
+        }
 
-        if(descr.channelHoppingSpecification.getChannelOffset() == dsmePANDescriptor.channelHoppingSpecification.getChannelOffset()) {
+        if(beacon.getChannelOffset() == dsmePANDescriptor.channelHoppingSpecification.getChannelOffset()) {
             /* Find a new channel offset to use if the current one is already used by a neighbor */
             uint16_t rndOffsetIdx = dsme.getPlatform().getRandom() % dsmePANDescriptor.channelHoppingSpecification.getChannelOffsetBitmapLength();
             while(dsmePANDescriptor.channelHoppingSpecification.getChannelOffsetBitmap().get(rndOffsetIdx) == 1) {
@@ -302,6 +415,7 @@ bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& d
 
             dsmePANDescriptor.channelHoppingSpecification.setChannelOffset(rndOffsetIdx);
             dsmePANDescriptor.channelHoppingSpecification.getChannelOffsetBitmap().set(rndOffsetIdx, 1);
+            beaconImage.invalidate();
             dsme.getMAC_PIB().macChannelOffset = dsmePANDescriptor.channelHoppingSpecification.getChannelOffset();
             LOG_INFO("Duplicate channel offset -> using " << dsme.getMAC_PIB().macChannelOffset << " now");
         }
@@ -312,17 +426,53 @@ bool BeaconManager::handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& d
         return true;
     }
 
+    if(this->dsme.isResumePending() &&
+       (msg->getHeader().getSrcPANId() != this->dsme.getMAC_PIB().macPANId || beacon.getSDIndex() != this->dsme.getMAC_PIB().macSyncParentSdIndex)) {
+        /* '-> the network changed during the restart, the restored allocations cannot be used */
+        LOG_INFO("Beacon of the SYNC parent does not match the restored state.");
+        this->dsme.finishResume(false);
+        indicateSyncLoss(LossReason::BEACON_LOST);
+        return true;
+    }
+
     /* Reset the number of missed beacons */
     this->missedBeacons = 0;
 
     // TODO do this on lower layer to gain accuracy and include offset in calculation
-    uint16_t lastHeardBeaconSDIndex = descr.getBeaconBitmap().getSDIndex();
+    uint16_t lastHeardBeaconSDIndex = beacon.getSDIndex();
 
     // -8 symbols for preamble
     // -2 symbols for SFD
-    uint32_t offset = descr.getTimeSyncSpec().getBeaconOffsetTimestampMicroSeconds() / aSymbolDuration;
-    lastKnownBeaconIntervalStart = msg->getStartOfFrameDelimiterSymbolCounter() -
+    uint32_t offset = beacon.getBeaconOffsetTimestampMicroSeconds() / aSymbolDuration;
+    uint32_t beaconIntervalStart = msg->getStartOfFrameDelimiterSymbolCounter() -
                                    lastHeardBeaconSDIndex * aNumSuperframeSlots * dsme.getMAC_PIB().helper.getSymbolsPerSlot() - 8 - 2 - offset;
+    updateClockDrift(beaconIntervalStart);
+    lastKnownBeaconIntervalStart = beaconIntervalStart;
+
+    if(this->dsme.isResumePending()) {
+        /* '-> restored state is confirmed and the slot timing is known now */
+        this->dsme.finishResume(true);
+    }
+
+    if(this->dsme.getMAC_PIB().macDynamicCapReduction && beacon.isCAPReduction() != dsmePANDescriptor.dsmeSuperframeSpec.CAPReductionFlag) {
+        /* '-> follow the CAP reduction of the SYNC parent, it switches at the start of the next beacon interval */
+        if(beacon.isCAPReduction() && !this->dsme.getMAC_PIB().helper.isCapReductionSwitchable()) {
+            LOG_ERROR("CAP reduction announced by the SYNC parent is not supported.");
+        } else {
+            announceCapReduction(beacon.isCAPReduction(), 1);
+        }
+    }
+
+    if(this->dsme.getMAC_PIB().macAutoRequest && this->dsme.getMAC_PIB().macAssociatedPANCoord &&
+       beacon.isAddressPending(this->dsme.getMAC_PIB().macShortAddress, this->dsme.getMAC_PIB().macExtendedAddress)) {
+        /* '-> the SYNC parent holds an indirect transmission for this device, fetch it during this CAP */
+        LOG_DEBUG("Indirect data pending at " << msg->getHeader().getSrcAddr().getShortAddress() << " -> POLL");
+        mlme_sap::POLL::request_parameters pollParams;
+        pollParams.coordAddrMode = msg->getHeader().getSrcAddrMode();
+        pollParams.coordPanId = msg->getHeader().getSrcPANId();
+        pollParams.coordAddress = msg->getHeader().getSrcAddr();
+        this->dsme.getMLME_SAP().getPOLL().requestFromMAC(pollParams);
+    }
 
     // Coordinator device request free beacon slots
     LOG_DEBUG("Checking if beacon has to be allocated: "
@@ -371,6 +521,7 @@ void BeaconManager::sendBeaconAllocationNotification(uint16_t beaconSDIndex) {
     // Update PANDDescription
     dsmePANDescriptor.getBeaconBitmap().setSDIndex(beaconSDIndex);
     dsmePANDescriptor.getBeaconBitmap().copyBitsFrom(this->dsme.getMAC_PIB().macSdBitmap);
+    beaconImage.invalidate();
 
     isBeaconAllocationSent = true;
 
@@ -460,10 +611,94 @@ void BeaconManager::onCSMASent(IDSMEMessage* msg, CommandFrameIdentifier cmdId,
 void BeaconManager::sendDone(enum AckLayerResponse result, IDSMEMessage* msg) {
     dsme.getPlatform().releaseMessage(msg);
     transmissionPending = false;
-    DSME_ASSERT(result == AckLayerResponse::NO_ACK_REQUESTED || result == AckLayerResponse::SEND_FAILED);
+    DSME_ASSERT(result == AckLayerResponse::NO_ACK_REQUESTED || result == AckLayerResponse::SEND_FAILED || result == AckLayerResponse::SEND_ABORTED);
     DSME_SIM_ASSERT(result == AckLayerResponse::NO_ACK_REQUESTED);
 }
 
+void BeaconManager::updateClockDrift(uint32_t beaconIntervalStart) {
+    uint16_t parent = this->dsme.getMAC_PIB().macSyncParentShortAddress;
+    if(!driftReferenceValid || parent != driftReferenceParent) {
+        /* '-> first beacon of this SYNC parent, only take the reference */
+        resetClockDrift();
+        driftReferenceParent = parent;
+        driftReferenceStart = beaconIntervalStart;
+        driftReferenceValid = true;
+        return;
+    }
+
+    uint32_t beaconInterval = this->dsme.getMAC_PIB().helper.getNumberSuperframesPerBeaconInterval() * aNumSuperframeSlots *
+                              this->dsme.getMAC_PIB().helper.getSymbolsPerSlot();
+    uint32_t elapsed = beaconIntervalStart - driftReferenceStart;
+    uint32_t intervals = (elapsed + beaconInterval / 2) / beaconInterval;
+    driftReferenceStart = beaconIntervalStart;
+
+    if(intervals == 0) {
+        /* '-> same beacon interval, e.g. a duplicate */
+        return;
+    }
+
+    /* deviation of the own clock from the nominal duration and from the duration predicted with the current estimate */
+    int32_t deviation = (int32_t)(elapsed - intervals * beaconInterval);
+    int64_t nominal = (int64_t)intervals * beaconInterval;
+    int32_t predictionError = deviation - (int32_t)(((int64_t)clockDrift * nominal) / 1000000000);
+    int32_t drift = (int32_t)(((int64_t)deviation * 1000000000) / nominal);
+
+    if(drift > MAX_CLOCK_DRIFT || drift < -MAX_CLOCK_DRIFT) {
+        /* '-> not plausible for a crystal, the parent or the own timing was reset */
+        LOG_DEBUG("Implausible clock drift of " << drift << " ppb -> ignore");
+        return;
+    }
+
+    /* exponentially weighted moving averages with a weight of 1/4 for the new sample */
+    clockDrift += (drift - clockDrift) / 4;
+
+    uint32_t errorPerInterval = (predictionError < 0 ? -predictionError : predictionError) / intervals;
+    syncErrorSymbols = (3 * syncErrorSymbols + errorPerInterval + 3) / 4;
+
+    LOG_DEBUG("Clock drift " << clockDrift << " ppb, sync error " << syncErrorSymbols << " symbols");
+}
+
+void BeaconManager::resetClockDrift() {
+    clockDrift = 0;
+    syncErrorSymbols = 0;
+    driftReferenceValid = false;
+}
+
+int32_t BeaconManager::getDriftCorrection(uint32_t symbolsSinceLastKnownBeaconIntervalStart) const {
+    return (int32_t)(((int64_t)clockDrift * symbolsSinceLastKnownBeaconIntervalStart) / 1000000000);
+}
+
+uint16_t BeaconManager::getExpectedSyncError(uint32_t now) const {
+    uint32_t beaconInterval = this->dsme.getMAC_PIB().helper.getNumberSuperframesPerBeaconInterval() * aNumSuperframeSlots *
+                              this->dsme.getMAC_PIB().helper.getSymbolsPerSlot();
+
+    /* the error grows since the last resynchronization, by beacon or by enhanced ACK */
+    uint32_t sinceSync = now - lastKnownBeaconIntervalStart;
+    if(now - lastTimeCorrection < sinceSync) {
+        sinceSync = now - lastTimeCorrection;
+    }
+
+    uint64_t error = ((uint64_t)sinceSync * syncErrorSymbols + beaconInterval - 1) / beaconInterval + 1;
+    return error > UINT16_MAX ? UINT16_MAX : error;
+}
+
+void BeaconManager::handleTimeCorrection(const IEEE802154MacAddress& ackSender, int16_t microseconds) {
+    if(this->dsme.getMAC_PIB().macIsPANCoord || !this->dsme.getMAC_PIB().macAssociatedPANCoord || this->dsme.isResumePending() ||
+       ackSender.getShortAddress() != this->dsme.getMAC_PIB().macSyncParentShortAddress) {
+        /* '-> only the SYNC parent defines the time base */
+        return;
+    }
+
+    int32_t symbols = microseconds / (int32_t)aSymbolDuration;
+    LOG_DEBUG("Time correction " << microseconds << " us from " << ackSender.getShortAddress());
+
+    DSME_ATOMIC_BLOCK {
+        /* a positive correction means the frame arrived too early, so the own slots start too early */
+        lastKnownBeaconIntervalStart += symbols;
+        lastTimeCorrection = this->dsme.getPlatform().getSymbolCounter();
+    }
+}
+
 void BeaconManager::handleBeacon(IDSMEMessage* msg) {
     if(dsme.getMAC_PIB().macIsPANCoord) {
         //* '-> do not handle beacon as PAN coordinator */
@@ -482,35 +717,45 @@ void BeaconManager::handleBeacon(IDSMEMessage* msg) {
         return;
     }
 
+    /* Only the fields required for tracking the neighbors are parsed here, the descriptor is decoded on demand */
+    BeaconView beacon;
+    beacon.decapsulateFrom(msg);
+
+    if(!beacon.isValid()) {
+        LOG_INFO("Malformed BEACON -> discard");
+        return;
+    }
+
+    bool beaconDiscarded = handleEnhancedBeacon(msg, beacon);
+    if(beaconDiscarded) {
+        return;
+    }
+
     /* Data exist or no macAutoRequest -> create indication */
 
     mlme_sap::BEACON_NOTIFY_indication_parameters params;
-    params.panDescriptor.dsmePANDescriptor.decapsulateFrom(msg);
-
-    bool beaconDiscarded = handleEnhancedBeacon(msg, params.panDescriptor.dsmePANDescriptor);
-
-    if(!beaconDiscarded) {
-        params.bsn = msg->getHeader().getSequenceNumber();
-        params.panDescriptor.coordAddrMode = msg->getHeader().getSrcAddrMode();
-        params.panDescriptor.coordPANId = msg->getHeader().getDstPANId();
-        params.panDescriptor.coordAddress = msg->getHeader().getSrcAddr();
-        params.panDescriptor.channelNumber = this->dsme.getPHY_PIB().phyCurrentChannel;
-        params.panDescriptor.channelPage = this->dsme.getPHY_PIB().phyCurrentPage;
-        params.panDescriptor.timestamp = msg->getStartOfFrameDelimiterSymbolCounter();
-        params.panDescriptor.linkQuality = msg->getLQI();
-        params.panDescriptor.rssi = msg->getRSSI();
-        //  TODO fill in the other indication_parameters,
-        //  some of the info is already included in the PANDesriptor.
-        //    params.pendAddrSpec;
-        //    params.addrList;
-        //    params.sduLength;
-        //    params.sdu;
-        params.ebsn = msg->getHeader().getSequenceNumber();
-        params.beaconType = msg->getHeader().isEnhancedBeacon();
-
-        this->dsme.getMAC_PIB().macPanCoordinatorBsn = params.ebsn;
-        this->dsme.getMLME_SAP().getBEACON_NOTIFY().notify_indication(params);
-    }
+    beacon.decode(params.panDescriptor.dsmePANDescriptor);
+
+    params.bsn = msg->getHeader().getSequenceNumber();
+    params.panDescriptor.coordAddrMode = msg->getHeader().getSrcAddrMode();
+    params.panDescriptor.coordPANId = msg->getHeader().getDstPANId();
+    params.panDescriptor.coordAddress = msg->getHeader().getSrcAddr();
+    params.panDescriptor.channelNumber = this->dsme.getPHY_PIB().phyCurrentChannel;
+    params.panDescriptor.channelPage = this->dsme.getPHY_PIB().phyCurrentPage;
+    params.panDescriptor.timestamp = msg->getStartOfFrameDelimiterSymbolCounter();
+    params.panDescriptor.linkQuality = msg->getLQI();
+    params.panDescriptor.rssi = msg->getRSSI();
+    //  TODO fill in the other indication_parameters,
+    //  some of the info is already included in the PANDesriptor.
+    //    params.pendAddrSpec;
+    //    params.addrList;
+    //    params.sduLength;
+    //    params.sdu;
+    params.ebsn = msg->getHeader().getSequenceNumber();
+    params.beaconType = msg->getHeader().isEnhancedBeacon();
+
+    this->dsme.getMAC_PIB().macPanCoordinatorBsn = params.ebsn;
+    this->dsme.getMLME_SAP().getBEACON_NOTIFY().notify_indication(params);
 
     if(this->scanning) {
         switch(this->scanType) {
@@ -624,34 +869,106 @@ void BeaconManager::handleStartOfCFP(uint16_t currentSuperframe, uint16_t curren
         this->missedBeacons = 0;
     }
 
+    updateCapReduction(currentSuperframe);
+
     if(this->dsme.isTrackingBeacons() && currentMultiSuperframe == 0 && currentSuperframe == 0) {
         /* Increment the number of missed beacons. This gets reset whenever a beacon is received */
         ++(this->missedBeacons);
         if(this->missedBeacons > aMaxLostBeacons) {
-            mlme_sap::SYNC_LOSS_indication_parameters params;
-            MAC_PIB& mac_pip = this->dsme.getMAC_PIB();
-            PHY_PIB& phy_pip = this->dsme.getPHY_PIB();
+            if(this->dsme.isResumePending()) {
+                /* '-> the SYNC parent of the restored state was not heard */
+                this->dsme.finishResume(false);
+            }
+            indicateSyncLoss(LossReason::BEACON_LOST);
+        }
+    }
 
-            params.lossReason = LossReason::BEACON_LOST;
-            params.panId = mac_pip.macPANId;
-            params.channelNumber = phy_pip.phyCurrentChannel;
-            params.channelPage = phy_pip.phyCurrentPage;
-            params.securityLevel = 0;
-            params.keyIdMode = 0;
-            params.keySource = nullptr;
-            params.keyIndex = 0;
+    return;
+}
 
-            this->dsme.stopTrackingBeacons();
+void BeaconManager::updateCapReduction(uint16_t currentSuperframe) {
+    if(!this->dsme.getMAC_PIB().macDynamicCapReduction || !this->dsme.getMAC_PIB().macIsPANCoord || currentSuperframe != 0) {
+        return;
+    }
+
+    /* the activity of all CAPs since the CAP of the previous first superframe */
+    uint16_t activity = this->dsme.getCapLayer().popCAPActivity();
+    if(this->capReductionCountdown > 0 || !this->dsme.getMAC_PIB().helper.isCapReductionSwitchable()) {
+        /* '-> wait until the last decision is applied */
+        this->idleMultiSuperframes = 0;
+        return;
+    }
+
+    if(!dsmePANDescriptor.dsmeSuperframeSpec.CAPReductionFlag) {
+        uint16_t numCAPs = this->dsme.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe();
+        if(numCAPs > 1 && activity <= CAP_REDUCTION_IDLE_ACTIVITY * numCAPs) {
+            this->idleMultiSuperframes++;
+        } else {
+            this->idleMultiSuperframes = 0;
+        }
+
+        if(this->idleMultiSuperframes >= CAP_REDUCTION_IDLE_MULTISUPERFRAMES) {
+            LOG_INFO("CAP idle (" << activity << ") -> announce CAP reduction");
+            announceCapReduction(true, 2);
+        }
+    } else if(activity > CAP_REDUCTION_BUSY_ACTIVITY) {
+        LOG_INFO("CAP busy (" << activity << ") -> announce end of CAP reduction");
+        announceCapReduction(false, 2);
+    }
+}
+
+void BeaconManager::announceCapReduction(bool capReduction, uint8_t beaconIntervals) {
+    dsmePANDescriptor.dsmeSuperframeSpec.CAPReductionFlag = capReduction;
+    beaconImage.invalidate();
+    this->idleMultiSuperframes = 0;
+    this->capReductionCountdown = beaconIntervals;
+    this->dsme.getGTSManager().prepareCapReduction(capReduction);
+}
+
+void BeaconManager::indicateSyncLoss(LossReason::Loss_Reason lossReason) {
+    mlme_sap::SYNC_LOSS_indication_parameters params;
+    MAC_PIB& mac_pip = this->dsme.getMAC_PIB();
+    PHY_PIB& phy_pip = this->dsme.getPHY_PIB();
+
+    params.lossReason = lossReason;
+    params.panId = mac_pip.macPANId;
+    params.channelNumber = phy_pip.phyCurrentChannel;
+    params.channelPage = phy_pip.phyCurrentPage;
+    params.securityLevel = 0;
+    params.keyIdMode = 0;
+    params.keySource = nullptr;
+    params.keyIndex = 0;
+
+    this->dsme.stopTrackingBeacons();
 
 #ifdef STATISTICS_BEACONS
-            printBeaconStatistics();
+    printBeaconStatistics();
 #endif
 
-            this->dsme.getMLME_SAP().getSYNC_LOSS().notify_indication(params);
+    this->dsme.getMLME_SAP().getSYNC_LOSS().notify_indication(params);
+}
+
+void BeaconManager::serializeState(Serializer& serializer) {
+    uint16_t sdIndex = dsmePANDescriptor.getBeaconBitmap().getSDIndex();
+    uint8_t allocated = isBeaconAllocated;
+    uint16_t channelOffset = this->dsme.getMAC_PIB().macChannelOffset;
+
+    serializer << sdIndex;
+    serializer << allocated;
+    serializer << channelOffset;
+
+    if(serializer.getType() == DESERIALIZATION) {
+        isBeaconAllocated = allocated && this->dsme.getMAC_PIB().macIsCoord;
+        isBeaconAllocationSent = false;
+        dsmePANDescriptor.getBeaconBitmap().setSDIndex(sdIndex);
+
+        this->dsme.getMAC_PIB().macChannelOffset = channelOffset;
+        if(this->dsme.getMAC_PIB().macChannelDiversityMode == Channel_Diversity_Mode::CHANNEL_HOPPING) {
+            dsmePANDescriptor.channelHoppingSpecification.setChannelOffset(channelOffset);
+            dsmePANDescriptor.channelHoppingSpecification.getChannelOffsetBitmap().set(channelOffset, 1);
         }
+        beaconImage.invalidate();
     }
-
-    return;
 }
 
 void BeaconManager::scanCurrentChannel() {
@@ -51,6 +51,28 @@
 #include "../../mac_services/mlme_sap/MLME_SAP.h"
 #include "../../mac_services/mlme_sap/SCAN.h"
 #include "../ackLayer/AckLayer.h"
+#include "./BeaconImage.h"
+#include "./BeaconView.h"
+
+/* CAP activity per CAP (transmissions, busy CCAs and receptions) up to which the CAPs of the latter superframes are considered idle */
+#ifndef CAP_REDUCTION_IDLE_ACTIVITY
+#define CAP_REDUCTION_IDLE_ACTIVITY 2
+#endif
+
+/* number of consecutive idle multi-superframes before the PAN coordinator enables the CAP reduction */
+#ifndef CAP_REDUCTION_IDLE_MULTISUPERFRAMES
+#define CAP_REDUCTION_IDLE_MULTISUPERFRAMES 4
+#endif
+
+/* CAP activity of the single remaining CAP of a multi-superframe above which the PAN coordinator disables the CAP reduction */
+#ifndef CAP_REDUCTION_BUSY_ACTIVITY
+#define CAP_REDUCTION_BUSY_ACTIVITY 16
+#endif
+
+/* number of times a beacon is deferred because of a busy channel if macDeferredBeaconUsed is set, afterwards it is skipped */
+#ifndef DEFERRED_BEACON_MAX_DEFERRALS
+#define DEFERRED_BEACON_MAX_DEFERRALS 3
+#endif
 
 namespace dsme {
 
@@ -70,18 +92,59 @@ public:
 
     /**
      * Called on reception of an EnhancedBeacon
+     * @return true if the beacon is discarded and must not be indicated to the upper layer
      */
-    bool handleEnhancedBeacon(IDSMEMessage* msg, DSMEPANDescriptor& descr);
+    bool handleEnhancedBeacon(IDSMEMessage* msg, const BeaconView& beacon);
 
     uint32_t getLastKnownBeaconIntervalStart() const {
         return lastKnownBeaconIntervalStart;
     }
 
+    /**
+     * Estimated drift of the own clock relative to the SYNC parent in parts per billion.
+     * Positive if the own clock runs faster than the one of the SYNC parent, 0 if no estimate is available.
+     */
+    int32_t getClockDrift() const {
+        return clockDrift;
+    }
+
+    /**
+     * Number of symbols the given duration, measured by the own clock since the last known beacon interval start,
+     * has to be reduced by to get the corresponding duration in the time base of the SYNC parent.
+     */
+    int32_t getDriftCorrection(uint32_t symbolsSinceLastKnownBeaconIntervalStart) const;
+
+    /**
+     * Expected synchronization error in symbols at the given time after drift compensation.
+     * Can be used to dimension guard times instead of assuming the worst case crystal drift.
+     */
+    uint16_t getExpectedSyncError(uint32_t now) const;
+
     void preSuperframeEvent(uint16_t nextSuperframe, uint16_t nextMultiSuperframe, uint32_t nextSlotTime);
     void superframeEvent(int32_t lateness, uint32_t currentSlotTime);
 
+    /**
+     * True while the CCA before a deferred beacon is performed, the result has to be passed to handleBeaconCCAResult then
+     */
+    bool isBeaconCCAPending() const {
+        return beaconCCAPending;
+    }
+
+    void handleBeaconCCAResult(bool success);
+
+    /**
+     * Called at the end of the deferral of a beacon
+     */
+    void handleBeaconTimer();
+
     void handleBeacon(IDSMEMessage* msg);
 
+    /**
+     * Applies the Time Correction IE of an enhanced ACK, only if it was sent by the SYNC parent.
+     * @param microseconds expected minus actual arrival time of the acknowledged frame at the ACK sender
+     */
+    void handleTimeCorrection(const IEEE802154MacAddress& ackSender, int16_t microseconds);
+
     bool isScanning() const;
 
     void startScanPassive(uint16_t scanDuration, const channelList_t& scanChannels);
@@ -114,6 +177,13 @@ public:
      */
     void handleBeaconRequest(IDSMEMessage*);
 
+    /**
+     * Stores or restores the own beacon allocation and channel offset for a warm restart
+     */
+    void serializeState(Serializer& serializer);
+
+    static constexpr uint8_t STATE_SERIALIZATION_LENGTH = 5;
+
 protected:
     DSMELayer& dsme;
 
@@ -126,14 +196,63 @@ protected:
 
     DSMEPANDescriptor dsmePANDescriptor;
 
+    /* serialized dsmePANDescriptor, has to be invalidated on every change of the descriptor */
+    BeaconImage beaconImage;
+
     long numBeaconCollision;
 
     uint8_t missedBeacons;
 
+    /* CLOCK DRIFT ESTIMATION */
+    static constexpr int32_t MAX_CLOCK_DRIFT = 200000; // 200 ppm, in parts per billion
+
+    int32_t clockDrift;            // in parts per billion
+    uint16_t syncErrorSymbols;     // smoothed absolute prediction error per beacon interval
+    uint32_t driftReferenceStart;  // beacon interval start of the last beacon of the SYNC parent
+    uint16_t driftReferenceParent; // SYNC parent the estimation refers to
+    bool driftReferenceValid;
+    uint32_t lastTimeCorrection;   // time of the last resynchronization by an enhanced ACK
+
+    void updateClockDrift(uint32_t beaconIntervalStart);
+    void resetClockDrift();
+
+    /* DYNAMIC CAP REDUCTION */
+    uint8_t idleMultiSuperframes;     // consecutive multi-superframes with an idle CAP, only for the PAN coordinator
+    uint8_t capReductionCountdown;    // beacon intervals until the announced CAP reduction is applied, 0 if none is pending
+
+    /**
+     * Decides about the CAP reduction from the CAP activity of the last multi-superframe, only for the PAN coordinator
+     */
+    void updateCapReduction(uint16_t currentSuperframe);
+
+    /**
+     * Announces the CAP reduction in the own beacon and applies it at the start of the given beacon interval,
+     * so all devices that hear the announcement in the same beacon interval switch together
+     */
+    void announceCapReduction(bool capReduction, uint8_t beaconIntervals);
+
+    /* DEFERRED BEACON */
+    bool beaconCCAPending;
+    uint8_t beaconDeferrals;
+    uint32_t beaconSlotTime;
+    uint16_t beaconSymbols;
+
+    /**
+     * Performs the CCA before a deferred beacon, a busy channel defers the beacon
+     */
+    void startBeaconCCA();
+
+    /**
+     * Defers the prepared beacon by a random number of backoff periods within the beacon slot
+     * @return false if the beacon does not fit into the beacon slot anymore
+     */
+    bool deferBeacon();
+
     /**
      * Send an enhanced Beacon directly
+     * @param beaconOffset symbols the transmission is deferred after the start of the beacon slot
      */
-    void prepareEnhancedBeacon(uint32_t startSlotTime);
+    void prepareEnhancedBeacon(uint32_t startSlotTime, uint16_t beaconOffset);
 
     /**
      * Send an enhanced Beacon request in scan primitive
@@ -152,6 +271,11 @@ protected:
 
     void sendDone(enum AckLayerResponse result, IDSMEMessage* msg);
 
+    /**
+     * Stop tracking beacons and notify the upper layer
+     */
+    void indicateSyncLoss(LossReason::Loss_Reason lossReason);
+
     AckLayer::done_callback_t doneCallback;
 
 private:
@@ -0,0 +1,208 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef BEACONVIEW_H_
+#define BEACONVIEW_H_
+
+#include "../../../dsme_platform.h"
+#include "../../helper/Integers.h"
+#include "../../mac_services/dataStructures/DSMEMessageElement.h"
+#include "../../mac_services/dataStructures/DSMEPANDescriptor.h"
+#include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
+#include "../../mac_services/dataStructures/Serializer.h"
+#include "../../mac_services/pib/dsme_phy_constants.h"
+
+namespace dsme {
+
+/**
+ * View of the DSME PAN descriptor of a received enhanced beacon.
+ * The descriptor is not copied, all fields are read in place from the buffer of the received message,
+ * so the view must not outlive the message. On decapsulation only the length fields are interpreted
+ * and checked against the end of the frame, all other fields are parsed on demand.
+ * This allows handling beacons of neighbors that are not the SYNC parent without decoding the whole descriptor.
+ */
+class BeaconView : public DSMEMessageElement {
+public:
+    BeaconView() : data(nullptr), available(0), valid(false), length(0), timeSyncOffset(0), channelHoppingOffset(0) {
+    }
+
+    /**
+     * False if the descriptor is truncated by the end of the received frame
+     */
+    bool isValid() const {
+        return valid;
+    }
+
+    uint16_t getBeaconOffsetTimestampMicroSeconds() const {
+        return read16(timeSyncOffset + 6);
+    }
+
+    uint16_t getSDIndex() const {
+        return read16(getBeaconBitmapOffset());
+    }
+
+    uint16_t getSDBitmapLengthBytes() const {
+        return read16(getBeaconBitmapOffset() + 2);
+    }
+
+    const uint8_t* getSDBitmap() const {
+        return data + getBeaconBitmapOffset() + 4;
+    }
+
+    /**
+     * Checks the pending address list for the given addresses, i.e. if the coordinator holds an indirect transmission for this device
+     */
+    bool isAddressPending(uint16_t shortAddress, const IEEE802154MacAddress& extendedAddress) const {
+        uint8_t offset = PENDING_ADDRESSES_OFFSET + 1;
+        for(uint8_t i = 0; i < getNumPendingShortAddresses(); i++, offset += 2) {
+            if(read16(offset) == shortAddress) {
+                return true;
+            }
+        }
+        for(uint8_t i = 0; i < getNumPendingExtendedAddresses(); i++, offset += 8) {
+            if(read16(offset) == extendedAddress.a1() && read16(offset + 2) == extendedAddress.a2() && read16(offset + 4) == extendedAddress.a3() &&
+               read16(offset + 6) == extendedAddress.a4()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * CAP reduction flag of the DSME superframe specification, which directly precedes the time synchronization specification
+     */
+    bool isCAPReduction() const {
+        return (data[timeSyncOffset - 1] >> 6) & 0x1;
+    }
+
+    uint16_t getChannelOffset() const {
+        return read16(channelHoppingOffset + 2);
+    }
+
+    /**
+     * Fully decodes the descriptor, only required if the beacon is to be indicated to the upper layer
+     */
+    void decode(DSMEPANDescriptor& descr) const {
+        DSME_ASSERT(valid);
+        Serializer serializer(data, DESERIALIZATION, length);
+        descr.serialize(serializer);
+    }
+
+    virtual uint8_t getSerializationLength() {
+        return length;
+    }
+
+    virtual void serialize(Serializer& serializer) {
+        DSME_ASSERT(serializer.getType() == DESERIALIZATION);
+        data = serializer.getData();
+        if(serializer.isLengthKnown()) {
+            available = serializer.getRemainingLength();
+        } else {
+            /* '-> without the end of the frame, the descriptor can only be bounded by the maximum frame size */
+            available = aMaxPHYPacketSize;
+        }
+        valid = false;
+        length = 0;
+
+        /* superframe specification and pending address specification, the address list determines the following offsets */
+        if(!extendBy(PENDING_ADDRESSES_OFFSET + 1)) {
+            return;
+        }
+        timeSyncOffset = PENDING_ADDRESSES_OFFSET + 1 + 2 * getNumPendingShortAddresses() + 8 * getNumPendingExtendedAddresses() + 1;
+
+        /* remaining fixed part up to the length of the SD bitmap */
+        if(!extendBy(getBeaconBitmapOffset() + 4 - length) || !extendBy(getSDBitmapLengthBytes())) {
+            return;
+        }
+
+        /* channel hopping specification up to the length of the channel offset bitmap */
+        channelHoppingOffset = length;
+        if(!extendBy(5) || !extendBy(data[channelHoppingOffset + 4])) {
+            return;
+        }
+
+        valid = true;
+        serializer.getDataRef() += length;
+    }
+
+private:
+    /* superframe specification (2), followed by the pending addresses and the DSME superframe specification (1) */
+    static constexpr uint8_t PENDING_ADDRESSES_OFFSET = 2;
+
+    uint8_t getNumPendingShortAddresses() const {
+        return data[PENDING_ADDRESSES_OFFSET] & 0x07;
+    }
+
+    uint8_t getNumPendingExtendedAddresses() const {
+        return (data[PENDING_ADDRESSES_OFFSET] >> 4) & 0x07;
+    }
+
+    uint8_t getBeaconBitmapOffset() const {
+        return timeSyncOffset + 8;
+    }
+
+    /**
+     * Includes the next bytes of the received frame in the view, fails if they exceed the end of the frame
+     */
+    bool extendBy(uint16_t bytes) {
+        if(length + bytes > available) {
+            return false;
+        }
+        length += bytes;
+        return true;
+    }
+
+    uint16_t read16(uint8_t offset) const {
+        return data[offset] | (data[offset + 1] << 8);
+    }
+
+    uint8_t* data;
+    uint8_t available;
+    bool valid;
+    uint8_t length;
+    uint8_t timeSyncOffset;
+    uint8_t channelHoppingOffset;
+};
+
+} /* namespace dsme */
+
+#endif /* BEACONVIEW_H_ */
@@ -57,7 +57,7 @@
 namespace dsme {
 
 CAPLayer::CAPLayer(DSMELayer& dsme)
-    : DSMEBufferedFSM<CAPLayer, CSMAEvent, 4>(&CAPLayer::stateIdle), dsme(dsme), NB(0), NR(0), totalNBs(0), CW(CW0), batteryLifeExt(false), slottedCSMA(true), sentPackets(0), failedPackets(0), successPackets(0), failedCCAs(0), doneCallback(DELEGATE(&CAPLayer::sendDone, *this)) {
+    : DSMEBufferedFSM<CAPLayer, CSMAEvent, 4>(&CAPLayer::stateIdle), dsme(dsme), NB(0), NR(0), CW(CW0), batteryLifeExt(false), slottedCSMA(true), adaptiveCSMA(false), adaptiveMinBE(0), adaptiveMaxBackoffs(0), totalNBs(0), doneCallback(DELEGATE(&CAPLayer::sendDone, *this)), sentPackets(0), failedPackets(0), successPackets(0), failedCCAs(0), performedCCAs(0), capActivity(0) {
         if(!slottedCSMA) {
             batteryLifeExt = false;
         }
@@ -69,8 +69,12 @@ void CAPLayer::reset() {
     this->totalNBs = 0;
     this->NR = 0;
     this->CW = CW0;
+    this->adaptiveMinBE = this->dsme.getMAC_PIB().macMinBE;
+    this->adaptiveMaxBackoffs = this->dsme.getMAC_PIB().macMaxCSMABackoffs;
+    this->capActivity = 0;
 
     while(!this->queue.empty()) {
+        actionSelectMessage();
         actionPopMessage(DataStatus::Data_Status::TRANSACTION_EXPIRED);
     }
 }
@@ -137,7 +141,7 @@ bool CAPLayer::pushMessage(IDSMEMessage* msg) {
 fsmReturnStatus CAPLayer::choiceRebackoff() {
     NB++;
     CW = CW0;
-    if(NB > dsme.getMAC_PIB().macMaxCSMABackoffs) {
+    if(NB > getMaxCSMABackoffs()) {
         actionPopMessage(DataStatus::CHANNEL_ACCESS_FAILURE);
         return transition(&CAPLayer::stateIdle);
     } else {
@@ -156,6 +160,7 @@ fsmReturnStatus CAPLayer::stateIdle(CSMAEvent& event) {
         CW = CW0;
 
         if(!queue.empty()) {
+            actionSelectMessage();
             return transition(&CAPLayer::stateBackoff);
         } else {
             return FSM_HANDLED;
@@ -163,6 +168,7 @@ fsmReturnStatus CAPLayer::stateIdle(CSMAEvent& event) {
     } else if(event.signal == CSMAEvent::MSG_PUSHED) {
         LOG_INFO("A CSMA message was pushed.");
         DSME_ASSERT(!queue.empty());
+        actionSelectMessage();
         return transition(&CAPLayer::stateBackoff);
     } else if(event.signal == CSMAEvent::CCA_SUCCESS || event.signal == CSMAEvent::CCA_FAILURE) {
         /* '-> only possible after reset */
@@ -183,18 +189,43 @@ fsmReturnStatus CAPLayer::stateIdle(CSMAEvent& event) {
 
 fsmReturnStatus CAPLayer::stateBackoff(CSMAEvent& event) {
     if(event.signal == CSMAEvent::ENTRY_SIGNAL) {
+        actionRestoreChannel();
         actionStartBackoffTimer();
         return FSM_HANDLED;
     } else if(event.signal == CSMAEvent::MSG_PUSHED) {
+        if(!queue.front()->getHeader().isCriticalEvent() && queue.hasCriticalEvent()) {
+            /* '-> a critical frame does not wait for the backoff of another frame, which starts over later */
+            NB = 0;
+            NR = 0;
+            totalNBs = 0;
+            CW = CW0;
+            actionSelectMessage();
+            return transition(&CAPLayer::stateBackoff);
+        }
         return FSM_IGNORED;
     } else if(event.signal == CSMAEvent::TIMER_FIRED) {
-        if(enoughTimeLeft()) {
+        if(queue.front()->getHeader().isCriticalEventExpired(dsme.getPlatform().getSymbolCounter())) {
+            LOG_INFO("Critical frame expired.");
+            actionPopMessage(DataStatus::TRANSACTION_EXPIRED);
+            return transition(&CAPLayer::stateIdle);
+        } else if(enoughTimeLeft()) {
             return transition(&CAPLayer::stateCCA);
         } else {
             // This only happens in rare cases (e.g. resync).
             // Normally the backoff is chosen large enough beforehand.
             // It also can occur in simulation when sending Beacon Requests
             // and a beacon is heared before the message is sent.
+            if(dsme.getMAC_PIB().macMultiChannelCAP) {
+                /* '-> serve a frame for the current part of the CAP instead, the backoff of the others ends in their part */
+                IDSMEMessage* previous = queue.front();
+                actionSelectMessage();
+                if(queue.front() != previous) {
+                    NB = 0;
+                    NR = 0;
+                    totalNBs = 0;
+                    CW = CW0;
+                }
+            }
             return transition(&CAPLayer::stateBackoff);
         }
     } else {
@@ -208,6 +239,10 @@ fsmReturnStatus CAPLayer::stateBackoff(CSMAEvent& event) {
 
 fsmReturnStatus CAPLayer::stateCCA(CSMAEvent& event) {
     if(event.signal == CSMAEvent::ENTRY_SIGNAL) {
+        if(dsme.getMAC_PIB().macMultiChannelCAP) {
+            /* the channel of the receiver is assessed, the frame is sent there as well */
+            dsme.getPlatform().setChannelNumber(dsme.getMessageDispatcher().getCAPChannel(queue.front()));
+        }
         if(!dsme.getPlatform().startCCA()) {
             return choiceRebackoff();
         } else {
@@ -216,9 +251,11 @@ fsmReturnStatus CAPLayer::stateCCA(CSMAEvent& event) {
     } else if(event.signal == CSMAEvent::MSG_PUSHED) {
         return FSM_IGNORED;
     } else if(event.signal == CSMAEvent::CCA_FAILURE) {
+        performedCCAs++;
         failedCCAs++;
         return choiceRebackoff();
     } else if(event.signal == CSMAEvent::CCA_SUCCESS) {
+        performedCCAs++;
         if(slottedCSMA) {
             return transition(&CAPLayer::stateContention);
         }
@@ -283,8 +320,8 @@ fsmReturnStatus CAPLayer::stateSending(CSMAEvent& event) {
         return transition(&CAPLayer::stateIdle);
     } else if(event.signal == CSMAEvent::SEND_FAILED) {
         failedPackets++;
-        /* check if a sending should by retries */
-        if(NR >= dsme.getMAC_PIB().macMaxFrameRetries) {
+        /* check if a sending should by retries, a demoted destination gets a single attempt to not block the others */
+        if(NR >= dsme.getMAC_PIB().macMaxFrameRetries || queue.isDemoted(queue.front())) {
             actionPopMessage(DataStatus::Data_Status::NO_ACK);
             return transition(&CAPLayer::stateIdle);
         } else {
@@ -321,6 +358,9 @@ uint16_t CAPLayer::symbolsRequired() {
 }
 
 void CAPLayer::handleStartOfCFP() {
+    adaptBackoff();
+    capActivity += sentPackets + failedCCAs;
+
     this->dsme.getPlatform().signalPRRCAP(((double)(sentPackets - failedPackets) / sentPackets));
     this->dsme.getPlatform().signalFailedPacketsPerCAP(failedPackets);
     failedPackets = 0;
@@ -328,6 +368,7 @@ void CAPLayer::handleStartOfCFP() {
     sentPackets = 0;
     this->dsme.getPlatform().signalFailedCCAs(failedCCAs);
     failedCCAs = 0;
+    performedCCAs = 0;
     this->dsme.getPlatform().signalSuccessPacketsCAP(successPackets);
     successPackets = 0;
 }
@@ -340,13 +381,70 @@ void CAPLayer::setBLE(bool ble) {
     batteryLifeExt = ble;
 }
 
+void CAPLayer::setAdaptiveCSMA(bool adaptive) {
+    adaptiveCSMA = adaptive;
+    adaptiveMinBE = this->dsme.getMAC_PIB().macMinBE;
+    adaptiveMaxBackoffs = this->dsme.getMAC_PIB().macMaxCSMABackoffs;
+}
+
+void CAPLayer::adaptBackoff() {
+    if(!adaptiveCSMA || (performedCCAs == 0 && sentPackets == 0)) {
+        /* '-> nothing learned about the channel during this CAP */
+        return;
+    }
+
+    const uint32_t ccaFailurePercent = performedCCAs > 0 ? 100 * failedCCAs / performedCCAs : 0;
+    const uint32_t sendFailurePercent = sentPackets > 0 ? 100 * failedPackets / sentPackets : 0;
+
+    if(ccaFailurePercent > CSMA_ADAPTIVE_BUSY_PERCENT || sendFailurePercent > CSMA_ADAPTIVE_BUSY_PERCENT) {
+        /* '-> spread the contenders over a larger window and give up later, the channel is only busy for a while */
+        if(adaptiveMinBE < this->dsme.getMAC_PIB().macMaxBE) {
+            adaptiveMinBE++;
+        }
+        if(adaptiveMaxBackoffs < CSMA_ADAPTIVE_MAX_BACKOFFS) {
+            adaptiveMaxBackoffs++;
+        }
+    } else if(ccaFailurePercent < CSMA_ADAPTIVE_QUIET_PERCENT && sendFailurePercent < CSMA_ADAPTIVE_QUIET_PERCENT) {
+        /* '-> hardly any contention, do not waste the CAP with idle backoffs */
+        if(adaptiveMinBE > CSMA_ADAPTIVE_MIN_BE) {
+            adaptiveMinBE--;
+        }
+        if(adaptiveMaxBackoffs > this->dsme.getMAC_PIB().macMaxCSMABackoffs) {
+            adaptiveMaxBackoffs--;
+        }
+    }
+    LOG_DEBUG("Adaptive CSMA: BE " << (uint16_t)adaptiveMinBE << ", backoffs " << (uint16_t)adaptiveMaxBackoffs);
+}
+
+void CAPLayer::countReceivedFrame() {
+    capActivity++;
+}
+
+uint16_t CAPLayer::popCAPActivity() {
+    uint16_t activity = capActivity;
+    capActivity = 0;
+    return activity;
+}
+
+uint8_t CAPLayer::getMinBE() {
+    if(queue.front()->getHeader().isCriticalEvent()) {
+        return CSMA_PRIORITY_BE;
+    }
+    return adaptiveCSMA ? adaptiveMinBE : this->dsme.getMAC_PIB().macMinBE;
+}
+
+uint8_t CAPLayer::getMaxCSMABackoffs() {
+    return adaptiveCSMA ? adaptiveMaxBackoffs : this->dsme.getMAC_PIB().macMaxCSMABackoffs;
+}
+
 void CAPLayer::actionStartBackoffTimer() {
     totalNBs++;
 
     uint8_t backoffExp;
 
-    if((int)this->dsme.getMAC_PIB().macMinBE < 2 || !batteryLifeExt || !slottedCSMA) {
-        backoffExp = this->dsme.getMAC_PIB().macMinBE + NB;
+    const uint8_t minBE = getMinBE();
+    if((int)minBE < 2 || !batteryLifeExt || !slottedCSMA) {
+        backoffExp = minBE + NB;
     } else {
         backoffExp = 2 + NB;
     }
@@ -359,23 +457,34 @@ void CAPLayer::actionStartBackoffTimer() {
     const uint16_t backoff = aUnitBackoffPeriod * (unitBackoffPeriods + 1); // +1 to avoid scheduling in the past
     const uint32_t symbolsPerSlot = this->dsme.getMAC_PIB().helper.getSymbolsPerSlot();
     const uint16_t blockedEnd = symbolsRequired() + PRE_EVENT_SHIFT;
-    const uint32_t capPhaseLength = dsme.getMAC_PIB().helper.getFinalCAPSlot(0) * symbolsPerSlot;
+
+    /* with a multi-channel CAP, the backoff only counts down in the part of the CAP the frame is sent in (see enoughTimeLeft) */
+    uint32_t capPhaseOffset = symbolsPerSlot;
+    uint32_t capPhaseLength = dsme.getMAC_PIB().helper.getFinalCAPSlot(0) * symbolsPerSlot;
+    if(dsme.getMAC_PIB().macMultiChannelCAP) {
+        if(dsme.getMessageDispatcher().usesCommonCAPChannel(queue.front())) {
+            capPhaseLength = symbolsPerSlot;
+        } else {
+            capPhaseOffset += symbolsPerSlot;
+            capPhaseLength -= symbolsPerSlot;
+        }
+    }
+    DSME_ASSERT(capPhaseLength > blockedEnd);
     const uint32_t usableCapPhaseLength = capPhaseLength - blockedEnd;
-    const uint32_t usableCapPhaseEnd = usableCapPhaseLength + symbolsPerSlot;
-    
+    const uint32_t usableCapPhaseEnd = usableCapPhaseLength + capPhaseOffset;
 
     DSME_ATOMIC_BLOCK {
         const uint32_t now = this->dsme.getPlatform().getSymbolCounter();
         const uint32_t symbolsSinceCapFrameStart = this->dsme.getSymbolsSinceCapFrameStart(now);
-        const uint32_t CAPStart = now + symbolsPerSlot - symbolsSinceCapFrameStart;
+        const uint32_t CAPStart = now + capPhaseOffset - symbolsSinceCapFrameStart;
 
         uint32_t backoffFromCAPStart;
-        if(symbolsSinceCapFrameStart < symbolsPerSlot) {
-            /* '-> currently in beacon slot before CAP */
+        if(symbolsSinceCapFrameStart < capPhaseOffset) {
+            /* '-> currently before the CAP (or the part of it) */
             backoffFromCAPStart = backoff;
         } else if(symbolsSinceCapFrameStart < usableCapPhaseEnd) {
             /* '-> currently inside CAP */
-            backoffFromCAPStart = backoff + symbolsSinceCapFrameStart - symbolsPerSlot;
+            backoffFromCAPStart = backoff + symbolsSinceCapFrameStart - capPhaseOffset;
         } else {
             /* '-> after CAP */
             backoffFromCAPStart = backoff + usableCapPhaseLength;
@@ -422,12 +531,67 @@ void CAPLayer::actionStartBackoffTimer() {
 }
 
 bool CAPLayer::enoughTimeLeft() {
-    return dsme.isWithinCAP(dsme.getPlatform().getSymbolCounter(), symbolsRequired());
+    uint32_t now = dsme.getPlatform().getSymbolCounter();
+    if(!dsme.isWithinCAP(now, symbolsRequired())) {
+        return false;
+    }
+    if(!dsme.getMAC_PIB().macMultiChannelCAP) {
+        return true;
+    }
+
+    /* broadcasts have to fit into the common first CAP slot, unicasts are sent in the remaining CAP slots */
+    uint32_t symbolsPerSlot = dsme.getMAC_PIB().helper.getSymbolsPerSlot();
+    uint32_t symbolsSinceCapFrameStart = dsme.getSymbolsSinceCapFrameStart(now);
+    if(dsme.getMessageDispatcher().usesCommonCAPChannel(queue.front())) {
+        return symbolsSinceCapFrameStart + symbolsRequired() <= 2 * symbolsPerSlot - PRE_EVENT_SHIFT;
+    } else {
+        return symbolsSinceCapFrameStart >= 2 * symbolsPerSlot;
+    }
+}
+
+void CAPLayer::actionRestoreChannel() {
+    if(!dsme.getMAC_PIB().macMultiChannelCAP) {
+        return;
+    }
+
+    /* outside of the CAP the channel is managed by the MessageDispatcher for the GTS */
+    uint32_t now = dsme.getPlatform().getSymbolCounter();
+    if(dsme.isWithinCAP(now, 0)) {
+        dsme.getPlatform().setChannelNumber(dsme.getMessageDispatcher().getCAPListenChannel(now));
+    }
+}
+
+void CAPLayer::actionSelectMessage() {
+    if(!dsme.getMAC_PIB().macMultiChannelCAP) {
+        DSME_ATOMIC_BLOCK {
+            queue.selectNext();
+        }
+        return;
+    }
+
+    /* prefer a frame for the current or next part of the CAP, so a frame for the other part does not block it */
+    uint32_t now = dsme.getPlatform().getSymbolCounter();
+    bool commonPart = !dsme.isWithinCAP(now, 0) || dsme.getSymbolsSinceCapFrameStart(now) < 2 * dsme.getMAC_PIB().helper.getSymbolsPerSlot();
+    CAPQueue::filter_t usesCommonCAPChannel = DELEGATE(&MessageDispatcher::usesCommonCAPChannel, dsme.getMessageDispatcher());
+    DSME_ATOMIC_BLOCK {
+        if(!queue.selectNext(usesCommonCAPChannel, commonPart)) {
+            queue.selectNext();
+        }
+    }
 }
 
 void CAPLayer::actionPopMessage(DataStatus::Data_Status status) {
     IDSMEMessage* msg = queue.front();
-    queue.pop();
+    if(status == DataStatus::SUCCESS || status == DataStatus::NO_ACK) {
+        if(msg->getHeader().isAckRequested() && !msg->getHeader().getDestAddr().isBroadcast()) {
+            queue.reportResult(msg, status == DataStatus::SUCCESS);
+        }
+    }
+    DSME_ATOMIC_BLOCK {
+        queue.pop();
+    }
+
+    actionRestoreChannel();
 
     uint8_t transmissionAttempts = NR + 1;
 
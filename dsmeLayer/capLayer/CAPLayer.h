@@ -46,10 +46,35 @@
 #include "../../../dsme_settings.h"
 #include "../../helper/DSMEBufferedFSM.h"
 #include "../../helper/DSMEFSM.h"
-#include "../../helper/DSMEQueue.h"
 #include "../../helper/Integers.h"
 #include "../../mac_services/DSME_Common.h"
 #include "../ackLayer/AckLayer.h"
+#include "./CAPQueue.h"
+
+/* Percentage of failed CCAs or failed transmissions in a CAP above which the adaptive CSMA increases the backoff exponent */
+#ifndef CSMA_ADAPTIVE_BUSY_PERCENT
+#define CSMA_ADAPTIVE_BUSY_PERCENT 30
+#endif
+
+/* Percentage of failed CCAs and failed transmissions in a CAP below which the adaptive CSMA decreases the backoff exponent */
+#ifndef CSMA_ADAPTIVE_QUIET_PERCENT
+#define CSMA_ADAPTIVE_QUIET_PERCENT 10
+#endif
+
+/* Lower bound of the backoff exponent of the adaptive CSMA */
+#ifndef CSMA_ADAPTIVE_MIN_BE
+#define CSMA_ADAPTIVE_MIN_BE 1
+#endif
+
+/* Backoff exponent for critical event frames if priority channel access is enabled */
+#ifndef CSMA_PRIORITY_BE
+#define CSMA_PRIORITY_BE 0
+#endif
+
+/* Upper bound of the number of backoffs per transmission attempt of the adaptive CSMA */
+#ifndef CSMA_ADAPTIVE_MAX_BACKOFFS
+#define CSMA_ADAPTIVE_MAX_BACKOFFS 8
+#endif
 
 namespace dsme {
 
@@ -77,6 +102,24 @@ public:
     void setSlottedCSMA(bool slotted);
     void setBLE(bool ble);
 
+    /**
+     * If enabled, the minimum backoff exponent and the number of backoffs are adapted
+     * at the end of every CAP to the fraction of failed CCAs and transmissions.
+     * Otherwise macMinBE and macMaxCSMABackoffs are used as configured.
+     */
+    void setAdaptiveCSMA(bool adaptive);
+
+    /**
+     * Counts a frame received during the CAP for the CAP activity
+     */
+    void countReceivedFrame();
+
+    /**
+     * Number of transmissions, busy CCAs and receptions during the CAPs since the last call.
+     * Used by the PAN coordinator to decide about the CAP reduction.
+     */
+    uint16_t popCAPActivity();
+
 private:
     /**
      * States
@@ -96,7 +139,9 @@ private:
      * Actions
      */
     void actionStartBackoffTimer();
+    void actionSelectMessage();
     void actionPopMessage(DataStatus::Data_Status);
+    void actionRestoreChannel();
 
     /**
      * Internal helper
@@ -104,6 +149,9 @@ private:
     fsmReturnStatus choiceRebackoff();
     bool enoughTimeLeft();
     uint16_t symbolsRequired();
+    void adaptBackoff();
+    uint8_t getMinBE();
+    uint8_t getMaxCSMABackoffs();
 
     /**
      * Attributes
@@ -115,9 +163,12 @@ private:
     static const uint8_t CW0 = 2;
     bool batteryLifeExt;
     bool slottedCSMA;
+    bool adaptiveCSMA;
+    uint8_t adaptiveMinBE;
+    uint8_t adaptiveMaxBackoffs;
     uint8_t totalNBs;
     AckLayer::done_callback_t doneCallback;
-    DSMEQueue<IDSMEMessage*, CAP_QUEUE_SIZE> queue;
+    CAPQueue queue;
 
     /**
      * Counters for statistics
@@ -126,6 +177,8 @@ private:
     uint32_t failedPackets;
     uint32_t successPackets;
     uint32_t failedCCAs;
+    uint32_t performedCCAs;
+    uint16_t capActivity;
 };
 
 } /* namespace dsme */
@@ -0,0 +1,253 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef CAPQUEUE_H_
+#define CAPQUEUE_H_
+
+#include "../../../dsme_platform.h"
+#include "../../../dsme_settings.h"
+#include "../../helper/DSMEDelegate.h"
+#include "../../helper/Integers.h"
+#include "../../interfaces/IDSMEMessage.h"
+#include "../messages/IEEE802154eMACHeader.h"
+
+/* Number of consecutive frames to a destination that have to fail until the destination is only served after all others */
+#ifndef CAP_QUEUE_DEMOTION_THRESHOLD
+#define CAP_QUEUE_DEMOTION_THRESHOLD 2
+#endif
+
+namespace dsme {
+
+/**
+ * Queue of the CAPLayer that avoids head-of-line blocking by serving the destinations round robin.
+ * The frames to a single destination stay in FIFO order. Destinations whose frames keep failing are
+ * demoted and only served if no other destination has a frame queued.
+ * Critical event frames (priority channel access) are always served first, in FIFO order.
+ *
+ * The frame to transmit next is chosen by selectNext() and stays at the front until it is popped.
+ */
+class CAPQueue {
+public:
+    typedef Delegate<bool(IDSMEMessage*)> filter_t;
+
+    CAPQueue() : size(0), selected(NONE), serviceCounter(0) {
+        for(uint16_t i = 0; i < CAP_QUEUE_SIZE; i++) {
+            destinations[i].used = false;
+        }
+    }
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    bool full() const {
+        return size == CAP_QUEUE_SIZE;
+    }
+
+    // assumes queue is not full
+    void push(IDSMEMessage* msg) {
+        DSME_ASSERT(size < CAP_QUEUE_SIZE);
+        messages[size++] = msg;
+    }
+
+    /**
+     * Chooses the oldest frame of the destination that was served least recently, preferring destinations that are not demoted.
+     * Assumes the queue is not empty.
+     */
+    void selectNext() {
+        DSME_ASSERT(size > 0);
+        bool found = select(nullptr, false);
+        DSME_ASSERT(found);
+    }
+
+    /**
+     * Like selectNext(), but only frames for which the filter returns the given value are considered.
+     * Critical event frames are still served first, even if they do not pass the filter.
+     * \return false if no frame qualifies, nothing is selected then
+     */
+    bool selectNext(filter_t filter, bool value) {
+        DSME_ASSERT(size > 0);
+        return select(&filter, value);
+    }
+
+    bool hasCriticalEvent() const {
+        for(uint16_t i = 0; i < size; i++) {
+            if(messages[i]->getHeader().isCriticalEvent()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    IDSMEMessage* front() const {
+        DSME_ASSERT(selected != NONE);
+        return messages[selected];
+    }
+
+    void pop() {
+        DSME_ASSERT(selected != NONE);
+        for(uint16_t i = selected + 1; i < size; i++) {
+            messages[i - 1] = messages[i];
+        }
+        size--;
+        selected = NONE;
+    }
+
+    /**
+     * Records the outcome of an acknowledged transmission to the destination of the given frame
+     */
+    void reportResult(IDSMEMessage* msg, bool success) {
+        Destination& destination = getDestination(getAddress(msg));
+        if(success) {
+            destination.failures = 0;
+        } else if(destination.failures < UINT8_MAX) {
+            destination.failures++;
+        }
+    }
+
+    bool isDemoted(IDSMEMessage* msg) {
+        const Destination* destination = findDestination(getAddress(msg));
+        return destination != nullptr && destination->failures >= CAP_QUEUE_DEMOTION_THRESHOLD;
+    }
+
+private:
+    static constexpr uint16_t NONE = UINT16_MAX;
+
+    struct Destination {
+        uint16_t address;
+        uint16_t lastServed;
+        uint8_t failures;
+        bool used;
+    };
+
+    /* Has to be called from within an atomic block */
+    bool select(filter_t* filter, bool value) {
+        for(uint16_t i = 0; i < size; i++) {
+            if(messages[i]->getHeader().isCriticalEvent()) {
+                selected = i;
+                return true;
+            }
+        }
+
+        bool bestDemoted = true;
+        uint16_t bestIdle = 0;
+        selected = NONE;
+        for(uint16_t i = 0; i < size; i++) {
+            if(filter != nullptr && (*filter)(messages[i]) != value) {
+                continue;
+            }
+
+            const Destination* destination = findDestination(getAddress(messages[i]));
+            bool demoted = destination != nullptr && destination->failures >= CAP_QUEUE_DEMOTION_THRESHOLD;
+            uint16_t idle = destination != nullptr ? (uint16_t)(serviceCounter - destination->lastServed) : UINT16_MAX;
+
+            if(selected == NONE || (bestDemoted && !demoted) || (bestDemoted == demoted && idle > bestIdle)) {
+                selected = i;
+                bestDemoted = demoted;
+                bestIdle = idle;
+            }
+        }
+
+        if(selected == NONE) {
+            return false;
+        }
+        getDestination(getAddress(messages[selected])).lastServed = serviceCounter++;
+        return true;
+    }
+
+    static uint16_t getAddress(IDSMEMessage* msg) {
+        return msg->getHeader().getDestAddr().getShortAddress();
+    }
+
+    Destination* findDestination(uint16_t address) {
+        for(uint16_t i = 0; i < CAP_QUEUE_SIZE; i++) {
+            if(destinations[i].used && destinations[i].address == address) {
+                return &destinations[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Returns the entry for the address, a new entry replaces one without queued frames.
+     * As there are not more destinations with queued frames than queued frames, such an entry always exists.
+     */
+    Destination& getDestination(uint16_t address) {
+        Destination* existing = findDestination(address);
+        if(existing != nullptr) {
+            return *existing;
+        }
+
+        Destination* replaced = nullptr;
+        for(uint16_t i = 0; i < CAP_QUEUE_SIZE && replaced == nullptr; i++) {
+            if(!destinations[i].used || !hasQueuedFrames(destinations[i].address)) {
+                replaced = &destinations[i];
+            }
+        }
+        DSME_ASSERT(replaced != nullptr);
+
+        replaced->address = address;
+        replaced->lastServed = serviceCounter - UINT16_MAX;
+        replaced->failures = 0;
+        replaced->used = true;
+        return *replaced;
+    }
+
+    bool hasQueuedFrames(uint16_t address) const {
+        for(uint16_t i = 0; i < size; i++) {
+            if(getAddress(messages[i]) == address) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    IDSMEMessage* messages[CAP_QUEUE_SIZE];
+    uint16_t size;
+    uint16_t selected;
+    uint16_t serviceCounter;
+    Destination destinations[CAP_QUEUE_SIZE];
+};
+
+} /* namespace dsme */
+
+#endif /* CAPQUEUE_H_ */
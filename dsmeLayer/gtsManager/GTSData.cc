@@ -50,6 +50,7 @@ GTSData::GTSData()
     : superframesInCurrentState(0),
       cmdToSend(static_cast<CommandFrameIdentifier>(0)),
       msgToSend(nullptr),
+      slotStructureChanged(false),
       notifyPartnerAddress(IEEE802154MacAddress::NO_SHORT_ADDRESS),
       responsePartnerAddress(IEEE802154MacAddress::NO_SHORT_ADDRESS) {
 }
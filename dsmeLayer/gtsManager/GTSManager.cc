@@ -53,6 +53,7 @@
 #include "../../mac_services/mlme_sap/DSME_GTS.h"
 #include "../../mac_services/pib/MAC_PIB.h"
 #include "../../mac_services/pib/PIBHelper.h"
+#include "../../mac_services/pib/dsme_mac_constants.h"
 #include "../DSMELayer.h"
 #include "../messageDispatcher/MessageDispatcher.h"
 #include "../messages/GTSReplyNotifyCmd.h"
@@ -107,6 +108,7 @@ GTSManager::GTSManager(DSMELayer& dsme) : GTSManagerFSM_t(&GTSManager::stateIdle
 }
 
 void GTSManager::initialize() {
+    dsme.getMAC_PIB().helper.checkStaticConfiguration();
     dsme.getMAC_PIB().macDSMESAB.initialize(dsme.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe(), dsme.getMAC_PIB().helper.getNumGTSlots(0),
                                             dsme.getMAC_PIB().helper.getNumGTSlots(1), dsme.getMAC_PIB().helper.getNumChannels());
     dsme.getMAC_PIB().macDSMEACT.initialize(dsme.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe(), dsme.getMAC_PIB().helper.getNumGTSlots(0),
@@ -126,6 +128,55 @@ void GTSManager::reset() {
     this->dsme.getMAC_PIB().macDSMEACT.clear();
 }
 
+void GTSManager::prepareCapReduction(bool capReduction) {
+    MAC_PIB& mac_pib = this->dsme.getMAC_PIB();
+    if(mac_pib.macCapReduction == capReduction || capReduction) {
+        /* '-> the latter superframes only gain slots by enabling the CAP reduction */
+        return;
+    }
+
+    uint8_t numSlotsLostToCAP = getNumSlotsLostToCAP();
+    for(DSMEAllocationCounterTable::iterator it = mac_pib.macDSMEACT.begin(); it != mac_pib.macDSMEACT.end(); ++it) {
+        if(it->getSuperframeID() > 0 && it->getGTSlotID() < numSlotsLostToCAP && it->getState() == VALID) {
+            LOG_INFO("Slot " << (uint16_t)it->getGTSlotID() << " " << it->getSuperframeID() << " will overlap with the CAP");
+            it->setState(INVALID);
+        }
+    }
+}
+
+void GTSManager::setCapReduction(bool capReduction) {
+    MAC_PIB& mac_pib = this->dsme.getMAC_PIB();
+    if(mac_pib.macCapReduction == capReduction) {
+        return;
+    }
+    LOG_INFO("CAP reduction " << (capReduction ? "enabled" : "disabled"));
+
+    /* the SAB specifications of pending negotiations are only valid for the previous slot structure */
+    for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
+        if(getState(i) != &GTSManager::stateIdle) {
+            dispatch(i, GTSEvent::SLOT_STRUCTURE_CHANGED);
+        }
+    }
+
+    if(!capReduction) {
+        /* '-> the remaining slots could not be deallocated in time, the platform is informed by the ACT */
+        uint8_t numSlotsLostToCAP = getNumSlotsLostToCAP();
+        for(DSMEAllocationCounterTable::iterator it = mac_pib.macDSMEACT.begin(); it != mac_pib.macDSMEACT.end(); ++it) {
+            if(it->getSuperframeID() > 0 && it->getGTSlotID() < numSlotsLostToCAP) {
+                LOG_INFO("DEALLOCATE: Slot " << (uint16_t)it->getGTSlotID() << " " << it->getSuperframeID() << " overlaps with the CAP");
+            }
+        }
+    }
+
+    /* without CAP reduction all superframes are structured like the first one, with it the latter superframes have no CAP at all */
+    uint8_t numGTSlotsLatterSuperframes = capReduction ? aNumSuperframeSlots - 1 : mac_pib.helper.getNumGTSlots(0);
+
+    /* the ACT checks the slots against the current structure, so the PIB is changed last */
+    mac_pib.macDSMEACT.setNumGTSlotsLatterSuperframes(numGTSlotsLatterSuperframes);
+    mac_pib.macDSMESAB.setNumGTSlotsLatterSuperframes(numGTSlotsLatterSuperframes);
+    mac_pib.macCapReduction = capReduction;
+}
+
 /*****************************
  * States
  *****************************/
@@ -227,6 +278,10 @@ fsmReturnStatus GTSManager::stateIdle(GTSEvent& event) {
             DSME_ASSERT(false);
             return FSM_IGNORED;
 
+        case GTSEvent::SLOT_STRUCTURE_CHANGED:
+            // nothing is pending
+            return FSM_IGNORED;
+
         case GTSEvent::CFP_STARTED: {
             // check if a slot should be deallocated, only if no reply or notify is pending
             for(DSMEAllocationCounterTable::iterator it = dsme.getMAC_PIB().macDSMEACT.begin(); it != dsme.getMAC_PIB().macDSMEACT.end(); ++it) {
@@ -290,6 +345,8 @@ fsmReturnStatus GTSManager::stateSending(GTSEvent& event) {
 
     switch(event.signal) {
         case GTSEvent::ENTRY_SIGNAL:
+            data[fsmId].slotStructureChanged = false;
+            return FSM_HANDLED;
         case GTSEvent::EXIT_SIGNAL:
             return FSM_IGNORED;
 
@@ -298,6 +355,11 @@ fsmReturnStatus GTSManager::stateSending(GTSEvent& event) {
             LOG_ERROR("CFP during sending");
             return FSM_IGNORED;
 
+        case GTSEvent::SLOT_STRUCTURE_CHANGED:
+            // the command is already queued, so the negotiation is aborted when it is sent
+            data[fsmId].slotStructureChanged = true;
+            return FSM_HANDLED;
+
         case GTSEvent::MLME_REQUEST_ISSUED:
         case GTSEvent::MLME_RESPONSE_ISSUED:
         case GTSEvent::RESPONSE_CMD_FOR_ME:
@@ -310,6 +372,21 @@ fsmReturnStatus GTSManager::stateSending(GTSEvent& event) {
             DSME_ASSERT(event.cmdId == DSME_GTS_REQUEST || event.cmdId == DSME_GTS_REPLY || event.cmdId == DSME_GTS_NOTIFY);
             DSME_ASSERT(event.cmdId == data[fsmId].cmdToSend);
 
+            if(data[fsmId].slotStructureChanged) {
+                /* '-> the SAB specification does not match the ACT anymore, UNCONFIRMED slots are deallocated regularly */
+                LOG_INFO("GTS negotiation aborted due to changed slot structure");
+                if(event.cmdId == DSME_GTS_REQUEST) {
+                    data[fsmId].pendingConfirm.status = GTSStatus::TRANSACTION_OVERFLOW; // TODO TRANSACTION_EXPIRED not available!
+                    this->dsme.getMLME_SAP().getDSME_GTS().notify_confirm(data[fsmId].pendingConfirm);
+                } else if(event.cmdId == DSME_GTS_REPLY) {
+                    mlme_sap::COMM_STATUS_indication_parameters params;
+                    // TODO also fill other fields
+                    params.status = CommStatus::Comm_Status::TRANSACTION_EXPIRED;
+                    this->dsme.getMLME_SAP().getCOMM_STATUS().notify_indication(params);
+                }
+                return transition(fsmId, &GTSManager::stateIdle);
+            }
+
             if(event.cmdId == DSME_GTS_NOTIFY) {
                 actUpdater.notifyDelivered(event.replyNotifyCmd.getSABSpec(), event.management, event.deviceAddr, event.replyNotifyCmd.getChannelOffset());
                 return transition(fsmId, &GTSManager::stateIdle);
@@ -496,8 +573,9 @@ fsmReturnStatus GTSManager::stateWaitForResponse(GTSEvent& event) {
             }
         }
 
-        case GTSEvent::CFP_STARTED: {
-            if(isTimeoutPending(fsmId)) {
+        case GTSEvent::CFP_STARTED:
+        case GTSEvent::SLOT_STRUCTURE_CHANGED: {
+            if(event.signal == GTSEvent::SLOT_STRUCTURE_CHANGED || isTimeoutPending(fsmId)) {
                 LOG_INFO("GTS timeout for response");
                 mlme_sap::DSME_GTS_confirm_parameters& pendingConfirm = data[fsmId].pendingConfirm;
 
@@ -554,8 +632,9 @@ fsmReturnStatus GTSManager::stateWaitForNotify(GTSEvent& event) {
             return transition(fsmId, &GTSManager::stateIdle);
         }
 
-        case GTSEvent::CFP_STARTED: {
-            if(isTimeoutPending(fsmId)) {
+        case GTSEvent::CFP_STARTED:
+        case GTSEvent::SLOT_STRUCTURE_CHANGED: {
+            if(event.signal == GTSEvent::SLOT_STRUCTURE_CHANGED || isTimeoutPending(fsmId)) {
                 LOG_INFO("GTS timeout for notify");
                 actUpdater.notifyTimeout(data[fsmId].pendingConfirm.dsmeSabSpecification, data[fsmId].pendingManagement,
                                          data[fsmId].pendingConfirm.deviceAddress, data[fsmId].pendingConfirm.channelOffset);
@@ -609,6 +688,9 @@ const char* GTSManager::signalToString(uint8_t signal) {
         case GTSEvent::SEND_COMPLETE:
             // return "SEND_COMPLETE";
             return "CO";
+        case GTSEvent::SLOT_STRUCTURE_CHANGED:
+            // return "SLOT_STRUCTURE_CHANGED";
+            return "SLOT";
         default:
             DSME_ASSERT(false);
             return nullptr;
@@ -689,6 +771,20 @@ bool GTSManager::handleMLMEResponse(GTSManagement& man, GTSReplyNotifyCmd& reply
     return dispatch(fsmId, GTSEvent::MLME_RESPONSE_ISSUED, destinationAddress, man, reply);
 }
 
+void GTSManager::sendAllocationNotify(uint16_t deviceAddr, Direction direction, const DSMESABSpecification& sabSpec) {
+    GTSManagement man(ManagementType::ALLOCATION, direction, Priority::LOW, GTSStatus::SUCCESS);
+    GTSReplyNotifyCmd notifyCmd(deviceAddr, sabSpec);
+
+    IDSMEMessage* msg = dsme.getPlatform().getEmptyMessage();
+    notifyCmd.prependTo(msg);
+
+    uint8_t UNUSED_ANYWAY = 0;
+    if(!sendGTSCommand(UNUSED_ANYWAY, msg, man, CommandFrameIdentifier::DSME_GTS_NOTIFY, IEEE802154MacAddress::SHORT_BROADCAST_ADDRESS, false)) {
+        LOG_INFO("NOTIFY could not be sent");
+        dsme.getPlatform().releaseMessage(msg);
+    }
+}
+
 bool GTSManager::handleGTSRequest(IDSMEMessage* msg) {
     // This can be directly passed to the upper layer.
     // There is no need to go over the state machine!
@@ -840,6 +936,7 @@ bool GTSManager::onCSMASent(IDSMEMessage* msg, CommandFrameIdentifier cmdId, Dat
             // If the ACK was lost, but the message itself was delivered successfully,
             // the RESPONSE or NOTIFY might already have been handled properly.
             // Same holds if the current state is not sending (see there)
+            // and for the notify of slots allocated without a handshake (see sendAllocationNotify)
             // TODO What about the states of the receiver and the neighbours?
             LOG_DEBUG("Outdated message");
             returnStatus = true;
@@ -1014,6 +1111,11 @@ int8_t GTSManager::getFsmIdFromNotifyForMe(IDSMEMessage* msg) {
     return GTS_STATE_MULTIPLICITY;
 }
 
+uint8_t GTSManager::getNumSlotsLostToCAP() {
+    /* '-> only valid while the CAP reduction is enabled */
+    return this->dsme.getMAC_PIB().helper.getNumGTSlots(1) - this->dsme.getMAC_PIB().helper.getNumGTSlots(0);
+}
+
 bool GTSManager::hasBusyFsm() {
     bool busyFsm = false;
     for(uint8_t i = 0; i < GTS_STATE_MULTIPLICITY; ++i) {
@@ -75,7 +75,7 @@ public:
         fill(args...);
     }
 
-    enum : uint8_t { MLME_REQUEST_ISSUED = USER_SIGNAL_START, MLME_RESPONSE_ISSUED, RESPONSE_CMD_FOR_ME, NOTIFY_CMD_FOR_ME, CFP_STARTED, SEND_COMPLETE };
+    enum : uint8_t { MLME_REQUEST_ISSUED = USER_SIGNAL_START, MLME_RESPONSE_ISSUED, RESPONSE_CMD_FOR_ME, NOTIFY_CMD_FOR_ME, CFP_STARTED, SEND_COMPLETE, SLOT_STRUCTURE_CHANGED };
 
     uint16_t deviceAddr;
     GTSManagement management;
@@ -109,6 +109,19 @@ public:
 
     void reset();
 
+    /**
+     * Prepares an announced switch of the CAP reduction.
+     * If the CAP is restored, the slots that will overlap with it are marked as INVALID, so they are deallocated regularly before the switch.
+     */
+    void prepareCapReduction(bool capReduction);
+
+    /**
+     * Switches the CAP reduction and adapts the slot structure of the ACT and the SAB.
+     * Pending negotiations are aborted, since they refer to the previous slot structure.
+     * The allocated slots keep their position within the superframe, slots that still overlap with the CAP afterwards are removed.
+     */
+    void setCapReduction(bool capReduction);
+
     /*
      * For external calling from upper layer (over MLME.request).
      * Request for allocating  new GTSSlots to specified Address.
@@ -121,6 +134,17 @@ public:
      */
     bool handleMLMERequest(uint16_t deviceAddr, GTSManagement& gtsManagement, GTSRequestCmd& gtsRequestAllocationCmd);
 
+    /*
+     * Announces slots that were allocated without a DSME GTS handshake, e.g. together with the association,
+     * by a DSME GTS notify broadcast, so the neighbors mark them as occupied in their SAB.
+     * The notify is not handled by the state machine.
+     *
+     * @param deviceAddr The address of the respective other device
+     * @param direction The direction as seen from the device that requested the slots
+     * @param sabSpec The allocated slots
+     */
+    void sendAllocationNotify(uint16_t deviceAddr, Direction direction, const DSMESABSpecification& sabSpec);
+
     /*
      * Called on reception of a GTS-response from upper layer.
      * Handles the response.
@@ -229,6 +253,7 @@ private:
     int8_t getFsmIdFromNotifyForMe(IDSMEMessage* msg);
 
     bool hasBusyFsm();
+    uint8_t getNumSlotsLostToCAP();
 
     /*
      * Attributes
@@ -0,0 +1,100 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DUPLICATEFILTER_H_
+#define DUPLICATEFILTER_H_
+
+#include "../../../dsme_settings.h"
+#include "../../helper/Integers.h"
+
+/* Number of neighbors whose last sequence number is remembered */
+#ifndef DUPLICATE_FILTER_SIZE
+#define DUPLICATE_FILTER_SIZE MAX_NEIGHBORS
+#endif
+
+namespace dsme {
+
+/**
+ * Remembers the sequence number of the last frame received from each neighbor to detect retransmissions
+ * of frames that were received before but whose ACK got lost.
+ * The table is directly indexed by the short address, neighbors mapping to the same entry replace each other.
+ */
+class DuplicateFilter {
+public:
+    DuplicateFilter() {
+        reset();
+    }
+
+    void reset() {
+        for(uint16_t i = 0; i < DUPLICATE_FILTER_SIZE; i++) {
+            entries[i].valid = false;
+        }
+    }
+
+    /**
+     * Records the frame and returns whether it is a duplicate of the last frame from the same neighbor
+     */
+    bool isDuplicate(uint16_t srcAddress, uint8_t seqNum) {
+        Entry& entry = entries[srcAddress % DUPLICATE_FILTER_SIZE];
+        if(entry.valid && entry.address == srcAddress && entry.seqNum == seqNum) {
+            return true;
+        }
+
+        entry.address = srcAddress;
+        entry.seqNum = seqNum;
+        entry.valid = true;
+        return false;
+    }
+
+private:
+    struct Entry {
+        uint16_t address;
+        uint8_t seqNum;
+        bool valid;
+    };
+
+    Entry entries[DUPLICATE_FILTER_SIZE];
+};
+
+} /* namespace dsme */
+
+#endif /* DUPLICATEFILTER_H_ */
@@ -0,0 +1,206 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef INDIRECTQUEUE_H_
+#define INDIRECTQUEUE_H_
+
+#include "../../../dsme_platform.h"
+#include "../../../dsme_settings.h"
+#include "../../helper/Integers.h"
+#include "../../interfaces/IDSMEMessage.h"
+#include "../../mac_services/dataStructures/PendingAddresses.h"
+#include "../messages/IEEE802154eMACHeader.h"
+
+/* Number of frames a coordinator holds for indirect transmission */
+#ifndef INDIRECT_QUEUE_SIZE
+#define INDIRECT_QUEUE_SIZE 8
+#endif
+
+namespace dsme {
+
+/**
+ * Frames a coordinator holds until the destination requests them by a DATA-REQUEST command (indirect transmission).
+ * The frames are kept in the order of arrival, each with the symbol counter value at which it expires.
+ */
+class IndirectQueue {
+public:
+    IndirectQueue() : size(0) {
+    }
+
+    bool isEmpty() const {
+        return size == 0;
+    }
+
+    bool isFull() const {
+        return size == INDIRECT_QUEUE_SIZE;
+    }
+
+    /**
+     * \return false if the queue is full
+     */
+    bool push(IDSMEMessage* msg, uint32_t expiry) {
+        if(isFull()) {
+            return false;
+        }
+        entries[size].msg = msg;
+        entries[size].expiry = expiry;
+        size++;
+        return true;
+    }
+
+    /**
+     * Returns the oldest frame for the given device without removing it, nullptr if there is none.
+     * A frame only matches if it was queued with the same addressing mode the device uses.
+     */
+    IDSMEMessage* find(AddrMode addrMode, const IEEE802154MacAddress& address) const {
+        for(uint8_t i = 0; i < size; i++) {
+            if(isDestination(entries[i].msg->getHeader(), addrMode, address)) {
+                return entries[i].msg;
+            }
+        }
+        return nullptr;
+    }
+
+    uint8_t count(AddrMode addrMode, const IEEE802154MacAddress& address) const {
+        uint8_t num = 0;
+        for(uint8_t i = 0; i < size; i++) {
+            if(isDestination(entries[i].msg->getHeader(), addrMode, address)) {
+                num++;
+            }
+        }
+        return num;
+    }
+
+    bool remove(IDSMEMessage* msg) {
+        for(uint8_t i = 0; i < size; i++) {
+            if(entries[i].msg == msg) {
+                erase(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Removes and returns a frame whose persistence time has elapsed, nullptr if there is none
+     */
+    IDSMEMessage* popExpired(uint32_t now) {
+        for(uint8_t i = 0; i < size; i++) {
+            if((int32_t)(now - entries[i].expiry) >= 0) {
+                IDSMEMessage* msg = entries[i].msg;
+                erase(i);
+                return msg;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Removes and returns the oldest frame, nullptr if the queue is empty
+     */
+    IDSMEMessage* popFront() {
+        if(isEmpty()) {
+            return nullptr;
+        }
+        IDSMEMessage* msg = entries[0].msg;
+        erase(0);
+        return msg;
+    }
+
+    /**
+     * Lists the destinations of the queued frames in the addressing mode they were queued with.
+     * If there are more destinations than a beacon can advertise, the ones of the oldest frames are listed.
+     */
+    void getPendingAddresses(PendingAddresses& pending) const {
+        pending.clear();
+        for(uint8_t i = 0; i < size && !pending.isFull(); i++) {
+            IEEE802154eMACHeader& header = entries[i].msg->getHeader();
+            switch(header.getDstAddrMode()) {
+                case SHORT_ADDRESS:
+                    pending.addShortAddress(header.getDestAddr().getShortAddress());
+                    break;
+                case EXTENDED_ADDRESS:
+                    pending.addExtendedAddress(header.getDestAddr());
+                    break;
+                default:
+                    /* '-> cannot be requested by a DATA-REQUEST, so it is not advertised */
+                    break;
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        IDSMEMessage* msg;
+        uint32_t expiry;
+    };
+
+    static bool isDestination(IEEE802154eMACHeader& header, AddrMode addrMode, const IEEE802154MacAddress& address) {
+        if(header.getDstAddrMode() != addrMode) {
+            return false;
+        }
+        switch(addrMode) {
+            case SHORT_ADDRESS:
+                /* '-> only the short part of the address is valid */
+                return header.getDestAddr().getShortAddress() == address.getShortAddress();
+            case EXTENDED_ADDRESS:
+                return header.getDestAddr() == address;
+            default:
+                return false;
+        }
+    }
+
+    void erase(uint8_t index) {
+        DSME_ASSERT(index < size);
+        for(uint8_t i = index + 1; i < size; i++) {
+            entries[i - 1] = entries[i];
+        }
+        size--;
+    }
+
+    Entry entries[INDIRECT_QUEUE_SIZE];
+    uint8_t size;
+};
+
+} /* namespace dsme */
+
+#endif /* INDIRECTQUEUE_H_ */
@@ -54,7 +54,10 @@
 #include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
 #include "../../mac_services/mcps_sap/DATA.h"
 #include "../../mac_services/mcps_sap/MCPS_SAP.h"
+#include "../../mac_services/mlme_sap/MLME_SAP.h"
+#include "../../mac_services/mlme_sap/POLL.h"
 #include "../../mac_services/pib/dsme_mac_constants.h"
+#include "../../mac_services/pib/dsme_phy_constants.h"
 #include "../../mac_services/pib/MAC_PIB.h"
 #include "../../mac_services/pib/PHY_PIB.h"
 #include "../../mac_services/pib/PIBHelper.h"
@@ -84,6 +87,9 @@ MessageDispatcher::~MessageDispatcher() {
             this->dsme.getPlatform().releaseMessage(msg);
         }
     }
+    while(!this->indirectQueue.isEmpty()) {
+        this->dsme.getPlatform().releaseMessage(this->indirectQueue.popFront());
+    }
 }
 
 void MessageDispatcher::initialize(void) {
@@ -93,6 +99,7 @@ void MessageDispatcher::initialize(void) {
 
 void MessageDispatcher::reset(void) {
     currentACTElement = dsme.getMAC_PIB().macDSMEACT.end();
+    duplicateFilter.reset();
 
     for(NeighborQueue<MAX_NEIGHBORS>::iterator it = neighborQueue.begin(); it != neighborQueue.end(); ++it) {
         while(!this->neighborQueue.isQueueEmpty(it)) {
@@ -111,6 +118,9 @@ void MessageDispatcher::reset(void) {
         NeighborQueue<MAX_NEIGHBORS>::iterator it = this->neighborQueue.begin();
         this->neighborQueue.eraseNeighbor(it);
     }
+    while(!this->indirectQueue.isEmpty()) {
+        confirmIndirect(this->indirectQueue.popFront(), DataStatus::TRANSACTION_EXPIRED);
+    }
 
     return;
 }
@@ -239,6 +249,9 @@ void MessageDispatcher::onCSMASent(IDSMEMessage* msg, DataStatus::Data_Status st
                     this->dsme.getAssociationManager().onCSMASent(msg, cmd.getCmdId(), status, numBackoffs);
                     break;
                 case DATA_REQUEST:
+                    this->dsme.getMLME_SAP().getPOLL().onCSMASent(status);
+                    this->dsme.getPlatform().releaseMessage(msg);
+                    break;
                 case DSME_ASSOCIATION_REQUEST:
                 case DSME_ASSOCIATION_RESPONSE:
                     DSME_ASSERT(false);
@@ -277,7 +290,13 @@ bool MessageDispatcher::sendInGTS(IDSMEMessage* msg, NeighborQueue<MAX_NEIGHBORS
             totalSize += it->queueSize;
         }
         LOG_INFO("NeighborQueue is at " << totalSize << "/" << TOTAL_GTS_QUEUE_SIZE << ".");
-        neighborQueue.pushBack(destIt, msg);
+        if(msg->getHeader().isCriticalEvent()) {
+            /* '-> sent in the next TX GTS to this neighbor, behind the frame that is prepared or in transmission, if any */
+            bool keepFront = this->preparedMsg != nullptr && !neighborQueue.isQueueEmpty(destIt) && neighborQueue.front(destIt) == this->preparedMsg;
+            neighborQueue.pushFront(destIt, msg, keepFront);
+        } else {
+            neighborQueue.pushBack(destIt, msg);
+        }
         this->dsme.getPlatform().signalQueueLength(totalSize+1);
         return true;
     } else {
@@ -306,85 +325,309 @@ bool MessageDispatcher::sendInCAP(IDSMEMessage* msg) {
     return true;
 }
 
-void MessageDispatcher::receive(IDSMEMessage* msg) {
-    IEEE802154eMACHeader macHdr = msg->getHeader();
+bool MessageDispatcher::usesCommonCAPChannel(IDSMEMessage* msg) {
+    return !this->dsme.getMAC_PIB().macMultiChannelCAP || msg->getHeader().getDstAddrMode() == NO_ADDRESS ||
+           msg->getHeader().getDestAddr().isBroadcast();
+}
 
-    switch(macHdr.getFrameType()) {
-        case IEEE802154eMACHeader::FrameType::BEACON: {
-            LOG_INFO("BEACON from " << macHdr.getSrcAddr().getShortAddress() << " " << macHdr.getSrcPANId() << " " << dsme.getCurrentSuperframe() << ".");
-            this->dsme.getBeaconManager().handleBeacon(msg);
-            this->dsme.getPlatform().releaseMessage(msg);
-            break;
-        }
+uint8_t MessageDispatcher::getCAPChannel(IDSMEMessage* msg) {
+    if(usesCommonCAPChannel(msg)) {
+        return this->dsme.getPHY_PIB().phyCurrentChannel;
+    }
+    return getCAPChannel(msg->getHeader().getDestAddr().getShortAddress());
+}
 
-        case IEEE802154eMACHeader::FrameType::COMMAND: {
-            MACCommand cmd;
-            cmd.decapsulateFrom(msg);
-            switch(cmd.getCmdId()) {
-                case CommandFrameIdentifier::DSME_GTS_REQUEST:
-                    LOG_INFO("DSME-GTS-REQUEST from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getGTSManager().handleGTSRequest(msg);
-                    break;
-                case CommandFrameIdentifier::DSME_GTS_REPLY:
-                    LOG_INFO("DSME-GTS-REPLY from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getGTSManager().handleGTSResponse(msg);
-                    break;
-                case CommandFrameIdentifier::DSME_GTS_NOTIFY:
-                    LOG_INFO("DSME-GTS-NOTIFY from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getGTSManager().handleGTSNotify(msg);
-                    break;
-                case CommandFrameIdentifier::ASSOCIATION_REQUEST:
-                    LOG_INFO("ASSOCIATION-REQUEST from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getAssociationManager().handleAssociationRequest(msg);
-                    break;
-                case CommandFrameIdentifier::ASSOCIATION_RESPONSE:
-                    LOG_INFO("ASSOCIATION-RESPONSE from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getAssociationManager().handleAssociationReply(msg);
-                    break;
-                case CommandFrameIdentifier::DISASSOCIATION_NOTIFICATION:
-                    LOG_INFO("DISASSOCIATION-NOTIFICATION from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getAssociationManager().handleDisassociationRequest(msg);
-                    break;
-                case CommandFrameIdentifier::DATA_REQUEST:
-                    /* Not implemented */
-                    break;
-                case CommandFrameIdentifier::DSME_BEACON_ALLOCATION_NOTIFICATION:
-                    LOG_INFO("DSME-BEACON-ALLOCATION-NOTIFICATION from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getBeaconManager().handleBeaconAllocation(msg);
-                    break;
-                case CommandFrameIdentifier::DSME_BEACON_COLLISION_NOTIFICATION:
-                    LOG_INFO("DSME-BEACON-COLLISION-NOTIFICATION from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getBeaconManager().handleBeaconCollision(msg);
-                    break;
-                case CommandFrameIdentifier::BEACON_REQUEST:
-                    LOG_INFO("BEACON_REQUEST from " << macHdr.getSrcAddr().getShortAddress() << ".");
-                    dsme.getBeaconManager().handleBeaconRequest(msg);
-                    break;
-                default:
-                    LOG_ERROR("Invalid cmd ID " << (uint16_t)cmd.getCmdId());
-                    // DSME_ASSERT(false);
-            }
-            dsme.getPlatform().releaseMessage(msg);
-            break;
-        }
+uint8_t MessageDispatcher::getCAPListenChannel(uint32_t time) {
+    uint32_t symbolsPerSlot = this->dsme.getMAC_PIB().helper.getSymbolsPerSlot();
+    if(!this->dsme.getMAC_PIB().macMultiChannelCAP || this->dsme.getSymbolsSinceCapFrameStart(time) < 2 * symbolsPerSlot) {
+        /* '-> the first CAP slot is shared by all devices */
+        return this->dsme.getPHY_PIB().phyCurrentChannel;
+    }
+    return getOwnCAPChannel();
+}
 
-        case IEEE802154eMACHeader::FrameType::DATA: {
-            if(currentACTElement != dsme.getMAC_PIB().macDSMEACT.end()) {
-                handleGTSFrame(msg);
-            } else {
-                createDataIndication(msg);
-            }
-            break;
-        }
+uint8_t MessageDispatcher::getOwnCAPChannel() {
+    /* without a short address the lower part of the extended address is used, as by the senders addressing it that way */
+    uint16_t ownAddress = this->dsme.getMAC_PIB().macShortAddress;
+    if(ownAddress >= IEEE802154MacAddress::NO_SHORT_ADDRESS) {
+        ownAddress = this->dsme.getMAC_PIB().macExtendedAddress.getShortAddress();
+    }
+    return getCAPChannel(ownAddress);
+}
 
-        default: {
-            LOG_ERROR((uint16_t)macHdr.getFrameType());
-            dsme.getPlatform().releaseMessage(msg);
-        }
+uint8_t MessageDispatcher::getCAPChannel(uint16_t shortAddress) {
+    const channelList_t& channels = this->dsme.getMAC_PIB().helper.getChannels();
+    if(channels.getLength() == 0) {
+        return this->dsme.getPHY_PIB().phyCurrentChannel;
+    }
+    return channels[shortAddress % channels.getLength()];
+}
+
+bool MessageDispatcher::sendIndirect(IDSMEMessage* msg) {
+    DSME_ASSERT(!msg->getHeader().getDestAddr().isBroadcast());
+
+    /* the persistence time is given in unit periods, i.e. beacon intervals, see IEEE 802.15.4-2011 6.7.4 */
+    MAC_PIB& pib = this->dsme.getMAC_PIB();
+    uint8_t beaconOrder = pib.macBeaconOrder < 15 ? pib.macBeaconOrder : 0;
+    uint64_t persistence = ((uint64_t)pib.macTransactionPersistenceTime * aBaseSuperframeDuration) << beaconOrder;
+    if(persistence > INT32_MAX) {
+        /* '-> keep the expiry comparable despite the wrap-around of the symbol counter */
+        persistence = INT32_MAX;
+    }
+
+    if(!this->indirectQueue.push(msg, this->dsme.getPlatform().getSymbolCounter() + persistence)) {
+        LOG_INFO("Indirect queue full!");
+        numUpperPacketsDroppedFullQueue++;
+        return false;
+    }
+    LOG_DEBUG("Holding frame for " << msg->getHeader().getDestAddr().getShortAddress() << " until it is requested.");
+    return true;
+}
+
+void MessageDispatcher::handleDataRequest(IDSMEMessage* msg) {
+    AddrMode requesterMode = msg->getHeader().getSrcAddrMode();
+    const IEEE802154MacAddress& requester = msg->getHeader().getSrcAddr();
+    IDSMEMessage* pending = this->indirectQueue.find(requesterMode, requester);
+    if(pending == nullptr) {
+        LOG_DEBUG("No indirect frame for " << requester.getShortAddress() << ".");
+        return;
+    }
+
+    /* tell the device to keep polling if there is more */
+    pending->getHeader().setFramePending(this->indirectQueue.count(requesterMode, requester) > 1);
+    if(sendInCAP(pending)) {
+        this->indirectQueue.remove(pending);
+    } else {
+        /* '-> remains queued until the next DATA-REQUEST or until it expires */
+    }
+}
+
+bool MessageDispatcher::hasIndirectFramesFor(IDSMEMessage* msg) {
+    if(msg->getHeader().getFrameType() != IEEE802154eMACHeader::FrameType::COMMAND || !msg->hasPayload()) {
+        return false;
+    }
+
+    MACCommand cmd;
+    cmd.decapsulateFrom(msg);
+    cmd.prependTo(msg); /* '-> the command is handled after the ACK was sent */
+    if(cmd.getCmdId() != DATA_REQUEST) {
+        return false;
+    }
+
+    return this->indirectQueue.find(msg->getHeader().getSrcAddrMode(), msg->getHeader().getSrcAddr()) != nullptr;
+}
+
+bool MessageDispatcher::updatePendingAddresses(PendingAddresses& pending) {
+    PendingAddresses current;
+    this->indirectQueue.getPendingAddresses(current);
+    if(current == pending) {
+        return false;
+    }
+    pending = current;
+    return true;
+}
+
+void MessageDispatcher::handleStartOfCFP() {
+    uint32_t now = this->dsme.getPlatform().getSymbolCounter();
+    IDSMEMessage* msg;
+    while((msg = this->indirectQueue.popExpired(now)) != nullptr) {
+        LOG_INFO("Indirect transmission to " << msg->getHeader().getDestAddr().getShortAddress() << " expired.");
+        numIndirectTransactionsExpired++;
+        confirmIndirect(msg, DataStatus::TRANSACTION_EXPIRED);
+    }
+}
+
+void MessageDispatcher::confirmIndirect(IDSMEMessage* msg, DataStatus::Data_Status status) {
+    mcps_sap::DATA_confirm_parameters params;
+    params.msduHandle = msg;
+    params.timestamp = 0;
+    params.rangingReceived = false;
+    params.gtsTX = false;
+    params.status = status;
+    params.numBackoffs = 0;
+    this->dsme.getMCPS_SAP().getDATA().notify_confirm(params);
+}
+
+bool MessageDispatcher::getTimeCorrection(IDSMEMessage* msg, int16_t& microseconds) {
+    bool pending;
+    uint32_t slotStart;
+    DSME_ATOMIC_BLOCK {
+        pending = this->rxGTSTimeCorrectionPending;
+        slotStart = this->rxGTSStart;
+        this->rxGTSTimeCorrectionPending = false;
+    }
+
+    if(!pending || this->currentACTElement == this->dsme.getMAC_PIB().macDSMEACT.end() || this->currentACTElement->getDirection() != RX ||
+       this->currentACTElement->getAddress() != msg->getHeader().getSrcAddr().getShortAddress()) {
+        return false;
+    }
+
+    // like for beacons, the SFD is expected 8 symbols (preamble) + 2 symbols (SFD) after the slot start
+    int32_t offset = (int32_t)(slotStart + 8 + 2 - msg->getStartOfFrameDelimiterSymbolCounter());
+    if(offset > 2047 / aSymbolDuration || offset < -2047 / aSymbolDuration) {
+        /* '-> not plausible for a frame sent at the start of the slot */
+        return false;
+    }
+
+    if(offset == 0) {
+        /* '-> the sender is in sync, a plain ACK suffices */
+        return false;
+    }
+
+    microseconds = offset * aSymbolDuration;
+    return true;
+}
+
+bool MessageDispatcher::expectsEnhancedAck(IDSMEMessage* msg) {
+    /* the receiver only answers IEEE 802.15.4-2015 frames in its RX GTS with an enhanced ACK */
+    return msg == this->preparedMsg && msg->getHeader().isVersion2015();
+}
+
+uint16_t MessageDispatcher::getGTSAckWaitDuration(IDSMEMessage* msg) {
+    if(msg->getHeader().isVersion2015()) {
+        return this->dsme.getMAC_PIB().helper.getEnhancedAckWaitDuration();
     }
+    return this->dsme.getMAC_PIB().helper.getAckWaitDuration();
+}
+
+void MessageDispatcher::receive(IDSMEMessage* msg) {
+    uint8_t frameType = msg->getHeader().getFrameType();
+    (this->*frameHandlers[frameType & 0x07])(msg);
     return;
 }
 
+const MessageDispatcher::frameHandler_t MessageDispatcher::frameHandlers[8] = {
+    &MessageDispatcher::receiveBeacon,      /* BEACON */
+    &MessageDispatcher::receiveData,        /* DATA */
+    &MessageDispatcher::receiveUnsupported, /* ACKNOWLEDGEMENT, handled by the AckLayer */
+    &MessageDispatcher::receiveCommand,     /* COMMAND */
+    &MessageDispatcher::receiveUnsupported, /* LLDN */
+    &MessageDispatcher::receiveUnsupported, /* MULTIPURPOSE */
+    &MessageDispatcher::receiveUnsupported, /* reserved */
+    &MessageDispatcher::receiveUnsupported  /* reserved */
+};
+
+void MessageDispatcher::receiveBeacon(IDSMEMessage* msg) {
+    const IEEE802154eMACHeader& macHdr = msg->getHeader();
+    LOG_INFO("BEACON from " << macHdr.getSrcAddr().getShortAddress() << " " << macHdr.getSrcPANId() << " " << dsme.getCurrentSuperframe() << ".");
+    this->dsme.getBeaconManager().handleBeacon(msg);
+    this->dsme.getPlatform().releaseMessage(msg);
+}
+
+namespace {
+
+struct CommandHandler {
+    void (*handle)(DSMELayer& dsme, IDSMEMessage* msg);
+    const char* name;
+};
+
+void handleGTSRequest(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getGTSManager().handleGTSRequest(msg);
+}
+
+void handleGTSReply(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getGTSManager().handleGTSResponse(msg);
+}
+
+void handleGTSNotify(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getGTSManager().handleGTSNotify(msg);
+}
+
+void handleAssociationRequest(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getAssociationManager().handleAssociationRequest(msg);
+}
+
+void handleAssociationResponse(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getAssociationManager().handleAssociationReply(msg);
+}
+
+void handleDisassociationNotification(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getAssociationManager().handleDisassociationRequest(msg);
+}
+
+void handleDataRequest(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getMessageDispatcher().handleDataRequest(msg);
+}
+
+void handleBeaconRequest(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getBeaconManager().handleBeaconRequest(msg);
+}
+
+void handleBeaconAllocationNotification(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getBeaconManager().handleBeaconAllocation(msg);
+}
+
+void handleBeaconCollisionNotification(DSMELayer& dsme, IDSMEMessage* msg) {
+    dsme.getBeaconManager().handleBeaconCollision(msg);
+}
+
+/* indexed by the CommandFrameIdentifier, unsupported commands have no handler */
+const CommandHandler commandHandlers[] = {
+    {nullptr, nullptr},                                                            /* 0x00 */
+    {&handleAssociationRequest, "ASSOCIATION-REQUEST"},                            /* 0x01 */
+    {&handleAssociationResponse, "ASSOCIATION-RESPONSE"},                          /* 0x02 */
+    {&handleDisassociationNotification, "DISASSOCIATION-NOTIFICATION"},            /* 0x03 */
+    {&handleDataRequest, "DATA-REQUEST"},                                          /* 0x04 */
+    {nullptr, nullptr},                                                            /* 0x05 */
+    {nullptr, nullptr},                                                            /* 0x06 */
+    {&handleBeaconRequest, "BEACON_REQUEST"},                                      /* 0x07 */
+    {nullptr, nullptr},                                                            /* 0x08 */
+    {nullptr, nullptr},                                                            /* 0x09 */
+    {nullptr, nullptr},                                                            /* 0x0a */
+    {nullptr, nullptr},                                                            /* 0x0b */
+    {nullptr, nullptr},                                                            /* 0x0c */
+    {nullptr, nullptr},                                                            /* 0x0d */
+    {nullptr, nullptr},                                                            /* 0x0e */
+    {nullptr, nullptr},                                                            /* 0x0f */
+    {nullptr, nullptr},                                                            /* 0x10 */
+    {nullptr, nullptr},                                                            /* 0x11 */
+    {nullptr, nullptr},                                                            /* 0x12 */
+    {nullptr, nullptr},                                                            /* 0x13 */
+    {nullptr, nullptr},                                                            /* 0x14 */
+    {&handleGTSRequest, "DSME-GTS-REQUEST"},                                       /* 0x15 */
+    {&handleGTSReply, "DSME-GTS-REPLY"},                                           /* 0x16 */
+    {&handleGTSNotify, "DSME-GTS-NOTIFY"},                                         /* 0x17 */
+    {nullptr, nullptr},                                                            /* 0x18 */
+    {nullptr, nullptr},                                                            /* 0x19 */
+    {&handleBeaconAllocationNotification, "DSME-BEACON-ALLOCATION-NOTIFICATION"}, /* 0x1a */
+    {&handleBeaconCollisionNotification, "DSME-BEACON-COLLISION-NOTIFICATION"}    /* 0x1b */
+};
+
+constexpr uint8_t NUM_COMMAND_HANDLERS = sizeof(commandHandlers) / sizeof(commandHandlers[0]);
+
+} /* anonymous namespace */
+
+void MessageDispatcher::receiveCommand(IDSMEMessage* msg) {
+    this->dsme.getCapLayer().countReceivedFrame();
+
+    MACCommand cmd;
+    cmd.decapsulateFrom(msg);
+
+    uint8_t cmdId = cmd.getCmdId();
+    if(cmdId < NUM_COMMAND_HANDLERS && commandHandlers[cmdId].handle != nullptr) {
+        LOG_INFO(commandHandlers[cmdId].name << " from " << msg->getHeader().getSrcAddr().getShortAddress() << ".");
+        commandHandlers[cmdId].handle(this->dsme, msg);
+    } else {
+        LOG_ERROR("Invalid cmd ID " << (uint16_t)cmdId);
+        // DSME_ASSERT(false);
+    }
+    this->dsme.getPlatform().releaseMessage(msg);
+}
+
+void MessageDispatcher::receiveData(IDSMEMessage* msg) {
+    if(currentACTElement != dsme.getMAC_PIB().macDSMEACT.end()) {
+        handleGTSFrame(msg);
+    } else {
+        this->dsme.getCapLayer().countReceivedFrame();
+        createDataIndication(msg);
+    }
+}
+
+void MessageDispatcher::receiveUnsupported(IDSMEMessage* msg) {
+    LOG_ERROR((uint16_t)msg->getHeader().getFrameType());
+    this->dsme.getPlatform().releaseMessage(msg);
+}
+
 bool MessageDispatcher::handlePreSlotEvent(uint8_t nextSlot, uint8_t nextSuperframe, uint8_t nextMultiSuperframe) {
     // Prepare next slot
     // Switch to next slot channel and radio mode
@@ -405,8 +648,8 @@ bool MessageDispatcher::handlePreSlotEvent(uint8_t nextSlot, uint8_t nextSuperfr
         /* '-> next slot will be GTS */
 
         unsigned nextGTS = nextSlot - (this->dsme.getMAC_PIB().helper.getFinalCAPSlot(nextSuperframe) + 1);
-        if(act.isAllocated(nextSuperframe, nextGTS)) {
-            /* '-> this slot might be used */
+        if(act.isAllocated(nextSuperframe, nextGTS) && !this->dsme.isResumePending()) {
+            /* '-> this slot might be used, restored slots only after the first beacon of the SYNC parent */
 
             this->currentACTElement = act.find(nextSuperframe, nextGTS);
             DSME_ASSERT(this->currentACTElement != act.end());
@@ -441,7 +684,7 @@ bool MessageDispatcher::handlePreSlotEvent(uint8_t nextSlot, uint8_t nextSuperfr
     } else if(nextSlot == 1) {
         /* '-> next slot will be CAP */
 
-        if(!this->dsme.getMAC_PIB().macCapReduction || nextSuperframe == 0) {
+        if(this->dsme.getMAC_PIB().helper.getFinalCAPSlot(nextSuperframe) > 0) {
             /* '-> active CAP slot */
 
             this->dsme.getPlatform().turnTransceiverOn();
@@ -450,26 +693,50 @@ bool MessageDispatcher::handlePreSlotEvent(uint8_t nextSlot, uint8_t nextSuperfr
             /* '-> CAP reduction */
             transceiverOffIfAssociated();
         }
+    } else if(nextSlot == 2 && this->dsme.getMAC_PIB().macMultiChannelCAP) {
+        /* '-> the common CAP slot is over, listen on the own channel for the remaining CAP */
+        if(this->dsme.getMAC_PIB().helper.getFinalCAPSlot(nextSuperframe) >= nextSlot) {
+            this->dsme.getPlatform().setChannelNumber(getOwnCAPChannel());
+        }
     }
 
     return true;
 }
 
 uint8_t MessageDispatcher::nextHoppingSequenceChannel(uint8_t nextSlot, uint8_t nextSuperframe, uint8_t nextMultiSuperframe) {
-    uint16_t hoppingSequenceLength = this->dsme.getMAC_PIB().macHoppingSequenceLength;
-    uint8_t ebsn = 0; // this->dsme.getMAC_PIB().macPanCoordinatorBsn;    //TODO is this set correctly
-    uint16_t sdIndex = nextSuperframe + this->dsme.getMAC_PIB().helper.getNumberSuperframesPerMultiSuperframe() * nextMultiSuperframe;
-    uint8_t numGTSlots = this->dsme.getMAC_PIB().helper.getNumGTSlots(sdIndex);
+    MAC_PIB& mac_pib = this->dsme.getMAC_PIB();
+    uint16_t hoppingSequenceLength = mac_pib.macHoppingSequenceLength;
+
+    if(hoppingSequenceLength != this->hoppingSequenceOffsetsLength || mac_pib.helper.getNumGTSlots(1) != this->hoppingSequenceOffsetsGTSlots ||
+       mac_pib.helper.getNumberSuperframesPerBeaconInterval() != this->hoppingSequenceOffsetsSuperframes) {
+        updateHoppingSequenceOffsets();
+    }
 
-    uint8_t slotId = this->currentACTElement->getGTSlotID();
-    uint16_t channelOffset = this->currentACTElement->getChannel();
+    uint16_t sdIndex = nextSuperframe + mac_pib.helper.getNumberSuperframesPerMultiSuperframe() * nextMultiSuperframe;
+    DSME_ASSERT(sdIndex < this->hoppingSequenceOffsetsSuperframes);
 
-    uint8_t channel =
-        this->dsme.getMAC_PIB().macHoppingSequenceList[(sdIndex * numGTSlots + slotId + channelOffset + ebsn) % hoppingSequenceLength];
-    LOG_INFO("Using channel " << channel << " - numGTSlots: " << numGTSlots << " EBSN: " << ebsn << " sdIndex: " << sdIndex
-                              << " slot: " << slotId << " Superframe " << nextSuperframe << " channelOffset: " << channelOffset
-                              << " Direction: " << currentACTElement->getDirection());
-    return channel;
+    // the EBSN (macPanCoordinatorBsn) is not considered yet, TODO is this set correctly
+    uint32_t index = (uint32_t) this->hoppingSequenceOffsets[sdIndex] + this->currentACTElement->getGTSlotID() + this->currentACTElement->getChannel();
+    if(index >= hoppingSequenceLength) {
+        index %= hoppingSequenceLength;
+    }
+
+    return mac_pib.macHoppingSequenceList[index];
+}
+
+void MessageDispatcher::updateHoppingSequenceOffsets() {
+    MAC_PIB& mac_pib = this->dsme.getMAC_PIB();
+
+    this->hoppingSequenceOffsetsLength = mac_pib.macHoppingSequenceLength;
+    this->hoppingSequenceOffsetsGTSlots = mac_pib.helper.getNumGTSlots(1);
+    this->hoppingSequenceOffsetsSuperframes = mac_pib.helper.getNumberSuperframesPerBeaconInterval();
+    DSME_ASSERT(this->hoppingSequenceOffsetsLength > 0);
+    DSME_ASSERT(this->hoppingSequenceOffsetsSuperframes <= MAX_TOTAL_SUPERFRAMES);
+
+    for(uint16_t sdIndex = 0; sdIndex < this->hoppingSequenceOffsetsSuperframes; sdIndex++) {
+        uint8_t numGTSlots = mac_pib.helper.getNumGTSlots(sdIndex);
+        this->hoppingSequenceOffsets[sdIndex] = ((uint32_t)sdIndex * numGTSlots) % this->hoppingSequenceOffsetsLength;
+    }
 }
 
 bool MessageDispatcher::handleSlotEvent(uint8_t slot, uint8_t superframe, int32_t lateness) {
@@ -502,6 +769,10 @@ void MessageDispatcher::handleGTS(int32_t lateness) {
 
         if(this->currentACTElement->getDirection() == RX) { // also if INVALID or UNCONFIRMED!
             /* '-> a message may be received during this slot */
+            DSME_ATOMIC_BLOCK {
+                this->rxGTSStart = this->dsme.getCurrentSlotTime();
+                this->rxGTSTimeCorrectionPending = true;
+            }
 
         } else if(this->currentACTElement->getState() == VALID) {
             /* '-> if any messages are queued for this link, send one */
@@ -573,14 +844,29 @@ bool MessageDispatcher::prepareNextMessageIfAny() {
         checkTimeToSendMessage = false;
         result = false;
     } else { // if there is a message to send retrieve a copy of it from the queue and set the flag to check if possible to send the message
-        checkTimeToSendMessage = true;
         this->preparedMsg = neighborQueue.front(this->lastSendGTSNeighbor);
+
+        uint32_t now = this->dsme.getPlatform().getSymbolCounter();
+        while(this->preparedMsg != nullptr && this->preparedMsg->getHeader().isCriticalEventExpired(now)) {
+            /* '-> the delay tolerance of a critical frame has passed, it must not be sent anymore */
+            neighborQueue.popFront(this->lastSendGTSNeighbor);
+            mcps_sap::DATA_confirm_parameters params;
+            params.msduHandle = this->preparedMsg;
+            params.timestamp = 0;
+            params.rangingReceived = false;
+            params.gtsTX = true;
+            params.status = DataStatus::TRANSACTION_EXPIRED;
+            params.numBackoffs = 0;
+            this->dsme.getMCPS_SAP().getDATA().notify_confirm(params);
+            this->preparedMsg = neighborQueue.front(this->lastSendGTSNeighbor);
+        }
+        checkTimeToSendMessage = (this->preparedMsg != nullptr);
     }
 
     if(checkTimeToSendMessage) {//if the timming for transmission must be checked
         // determined how long the transmission of the preparedMessage will take.
         uint8_t ifsSymbols = this->preparedMsg->getTotalSymbols() <= aMaxSIFSFrameSize ? const_redefines::macSIFSPeriod : const_redefines::macLIFSPeriod;
-        uint32_t duration = this->preparedMsg->getTotalSymbols() + this->dsme.getMAC_PIB().helper.getAckWaitDuration() + ifsSymbols;
+        uint32_t duration = this->preparedMsg->getTotalSymbols() + getGTSAckWaitDuration(this->preparedMsg) + ifsSymbols;
         // check if the remaining slot time is enough to transmit the prepared packet
         if(!this->dsme.isWithinTimeSlot(this->dsme.getPlatform().getSymbolCounter(), duration)) {
             LOG_DEBUG("No packet prepared (remaining slot time insufficient)");
@@ -595,10 +881,10 @@ bool MessageDispatcher::prepareNextMessageIfAny() {
 
 bool MessageDispatcher::sendPreparedMessage() {
     DSME_ASSERT(this->preparedMsg);
-    DSME_ASSERT(this->dsme.getMAC_PIB().helper.getSymbolsPerSlot() >= this->preparedMsg->getTotalSymbols() + this->dsme.getMAC_PIB().helper.getAckWaitDuration() + 10 /* arbitrary processing delay */ + PRE_EVENT_SHIFT);
+    DSME_ASSERT(this->dsme.getMAC_PIB().helper.getSymbolsPerSlot() >= this->preparedMsg->getTotalSymbols() + getGTSAckWaitDuration(this->preparedMsg) + 10 /* arbitrary processing delay */ + PRE_EVENT_SHIFT);
 
     uint8_t ifsSymbols = this->preparedMsg->getTotalSymbols() <= aMaxSIFSFrameSize ? const_redefines::macSIFSPeriod : const_redefines::macLIFSPeriod;
-    uint32_t duration = this->preparedMsg->getTotalSymbols() + this->dsme.getMAC_PIB().helper.getAckWaitDuration() + ifsSymbols;
+    uint32_t duration = this->preparedMsg->getTotalSymbols() + getGTSAckWaitDuration(this->preparedMsg) + ifsSymbols;
     /* '-> Duration for the transmission of the next frame */
 
     if(this->dsme.isWithinTimeSlot(this->dsme.getPlatform().getSymbolCounter(), duration)) {
@@ -621,6 +907,15 @@ bool MessageDispatcher::sendPreparedMessage() {
 void MessageDispatcher::createDataIndication(IDSMEMessage* msg) {
     IEEE802154eMACHeader& header = msg->getHeader();
 
+    if(header.hasSequenceNumber() && header.hasSourceAddress() &&
+       this->duplicateFilter.isDuplicate(header.getSrcAddr().getShortAddress(), header.getSequenceNumber())) {
+        /* '-> retransmission of a frame whose ACK was lost */
+        LOG_DEBUG("Duplicate frame " << (uint16_t)header.getSequenceNumber() << " from " << header.getSrcAddr().getShortAddress());
+        this->numDuplicatesSuppressed++;
+        this->dsme.getPlatform().releaseMessage(msg);
+        return;
+    }
+
     mcps_sap::DATA_indication_parameters params;
 
     params.msdu = msg;
@@ -639,14 +934,17 @@ void MessageDispatcher::createDataIndication(IDSMEMessage* msg) {
     params.rangingOffset = 0;
     params.rangingFom = 0;
 
+    /* the indication hands over the message, so remember the sender for a pending POLL */
+    IEEE802154MacAddress srcAddr = header.getSrcAddr();
     this->dsme.getMCPS_SAP().getDATA().notify_indication(params);
+    this->dsme.getMLME_SAP().getPOLL().handleDataReceived(srcAddr);
 }
 
 void MessageDispatcher::transceiverOffIfAssociated() {
-    if(this->dsme.getMAC_PIB().macAssociatedPANCoord) {
+    if(this->dsme.getMAC_PIB().macAssociatedPANCoord && !this->dsme.isResumePending()) {
         this->dsme.getPlatform().turnTransceiverOff();
     } else {
-        /* '-> do not turn off the transceiver while we might be scanning */
+        /* '-> do not turn off the transceiver while we might be scanning or waiting for the SYNC parent */
     }
 }
 
@@ -48,6 +48,8 @@
 #include "../../mac_services/dataStructures/DSMEAllocationCounterTable.h"
 #include "../ackLayer/AckLayer.h"
 #include "../neighbors/NeighborQueue.h"
+#include "./DuplicateFilter.h"
+#include "./IndirectQueue.h"
 
 namespace dsme {
 
@@ -81,6 +83,46 @@ public:
      */
     bool sendInCAP(IDSMEMessage* msg);
 
+    /*! Determines the channel for the transmission of a CAP frame. With macMultiChannelCAP unicast frames use the channel
+     *  the receiver listens on, otherwise and for broadcasts this is the common channel.
+     */
+    uint8_t getCAPChannel(IDSMEMessage* msg);
+
+    /*! Determines the channel to listen on during the CAP at the given time.
+     */
+    uint8_t getCAPListenChannel(uint32_t time);
+
+    /*! Whether the frame is sent on the common channel, i.e. in the first CAP slot if macMultiChannelCAP is set.
+     */
+    bool usesCommonCAPChannel(IDSMEMessage* msg);
+
+    /*! Holds a message until the destination requests it by a DATA-REQUEST command (indirect transmission).
+     *  The message expires after macTransactionPersistenceTime.
+     *
+     * \param msg The message to transmit
+     * \return false if the indirect queue is full, true otherwise
+     */
+    bool sendIndirect(IDSMEMessage* msg);
+
+    /*! Passes the oldest message held for the sender of a DATA-REQUEST command to the #CAPLayer.
+     *
+     * \param msg The received DATA-REQUEST command, it remains owned by the caller
+     */
+    void handleDataRequest(IDSMEMessage* msg);
+
+    /*! Checks if the ACK for a received frame has to set the frame pending bit.
+     *
+     * \param msg The received frame, its payload is left unchanged
+     * \return true if it is a DATA-REQUEST command and frames are held for its sender
+     */
+    bool hasIndirectFramesFor(IDSMEMessage* msg);
+
+    /*! Lists the destinations of the indirect transmissions for advertisement in the beacon.
+     *
+     * \param pending The list to update
+     * \return true if the list changed
+     */
+    bool updatePendingAddresses(PendingAddresses& pending);
 
     inline NeighborQueue<MAX_NEIGHBORS>& getNeighborQueue() {
         return neighborQueue;
@@ -127,6 +169,10 @@ public:
      */
     bool handleIFSEvent(int32_t lateness);
 
+    /*! This shall be called at the start of the CFP of every superframe. Expires indirect transmissions.
+     */
+    void handleStartOfCFP();
+
     /*! This shall be called when CSMA Message was sent down to the physical layer.
      *
      * \param msg The sent message
@@ -143,6 +189,22 @@ public:
      */
     void sendDoneGTS(enum AckLayerResponse response, IDSMEMessage* msg);
 
+    /*! Determines the time correction for the acknowledgement of a received frame.
+     *  Only the first frame in an RX GTS is sent at a known time (the start of the slot), so only that one yields a correction.
+     *
+     * \param msg The received message that requests an acknowledgement
+     * \param microseconds Expected minus actual arrival time of the frame
+     * \return true if the sender is out of sync and should get an enhanced ACK
+     */
+    bool getTimeCorrection(IDSMEMessage* msg, int16_t& microseconds);
+
+    /*! Whether the ACK for a transmitted message may carry a Time Correction IE.
+     *
+     * \param msg The message that is currently transmitted
+     * \return true if the message is sent in a TX GTS with IEEE 802.15.4-2015 framing
+     */
+    bool expectsEnhancedAck(IDSMEMessage* msg);
+
     /*! This shall be called to receive a message after it has been decoupled from
      * the ISR control flow.
      *
@@ -165,6 +227,14 @@ protected:
 
     IDSMEMessage *preparedMsg{nullptr};
 
+    DuplicateFilter duplicateFilter;
+
+    IndirectQueue indirectQueue;
+
+    /* start of the current RX GTS, while no frame was received in it */
+    bool rxGTSTimeCorrectionPending{false};
+    uint32_t rxGTSStart{0};
+
     /*!
      * Called on start of every GTSlot.
      * Switch channel for reception or transmit from queue in allocated slots. TODO: correct?
@@ -192,8 +262,26 @@ protected:
      */
     bool sendPreparedMessage();
 
+    /*! Time to wait for the ACK of a GTS frame, which may be an enhanced ACK with a Time Correction IE. */
+    uint16_t getGTSAckWaitDuration(IDSMEMessage* msg);
+
     void createDataIndication(IDSMEMessage* msg);
 
+    void confirmIndirect(IDSMEMessage* msg, DataStatus::Data_Status status);
+
+    uint8_t getCAPChannel(uint16_t shortAddress);
+    uint8_t getOwnCAPChannel();
+
+    /*! Handlers for received frames, indexed by the frame type. Each of them takes over the message.
+     */
+    typedef void (MessageDispatcher::*frameHandler_t)(IDSMEMessage* msg);
+    static const frameHandler_t frameHandlers[8];
+
+    void receiveBeacon(IDSMEMessage* msg);
+    void receiveCommand(IDSMEMessage* msg);
+    void receiveData(IDSMEMessage* msg);
+    void receiveUnsupported(IDSMEMessage* msg);
+
     /*! Finalizes the current GTS. Turns off the transceiver if transmitting,
      *  resets the neighbor associated with the time slot and ensures there
      *  is no message pending.
@@ -206,6 +294,17 @@ protected:
      */
     uint8_t nextHoppingSequenceChannel(uint8_t nextSlot, uint8_t nextSuperframe, uint8_t nextMultiSuperframe);
 
+    /*! Precomputes the position in the hopping sequence of the first GT slot of every superframe in the beacon interval.
+     */
+    void updateHoppingSequenceOffsets();
+
+    uint16_t hoppingSequenceOffsets[MAX_TOTAL_SUPERFRAMES];
+
+    /* configuration the hopping sequence offsets were calculated for */
+    uint16_t hoppingSequenceOffsetsLength{0};
+    uint8_t hoppingSequenceOffsetsGTSlots{0};
+    uint16_t hoppingSequenceOffsetsSuperframes{0};
+
 
 
 
@@ -231,6 +330,14 @@ public:
         return this->numUnusedRxGts;
     }
 
+    long getNumDuplicatesSuppressed() const {
+        return this->numDuplicatesSuppressed;
+    }
+
+    long getNumIndirectTransactionsExpired() const {
+        return this->numIndirectTransactionsExpired;
+    }
+
 private:
     long numTxGtsFrames = 0;
     long numRxAckFrames = 0;
@@ -240,6 +347,8 @@ private:
     long numUpperPacketsDroppedFullQueue = 0;
     long numUpperPacketsForCAP = 0;
     long numUpperPacketsForGTS = 0;
+    long numDuplicatesSuppressed = 0;
+    long numIndirectTransactionsExpired = 0;
     bool recordGtsUpdates = false;
 /* Statistics (END) --------------------------------------------------------- */
 };
@@ -48,12 +48,20 @@
 namespace dsme {
 class DSMEAssociationRequestCmd : public AssociateRequestCmd {
 public:
-    DSMEAssociationRequestCmd() : hoppingSequenceId(0), channelOffset(0) {
+    /**
+     * @param gtsAllocationExtension if the non-standard extended DSME GTS allocation octet is present, see macAssociationGTSAllocation
+     */
+    explicit DSMEAssociationRequestCmd(bool gtsAllocationExtension)
+        : hoppingSequenceId(0), channelOffset(0), extendedDsmeGtsAllocation(0), gtsAllocationExtension(gtsAllocationExtension) {
     }
 
-    explicit DSMEAssociationRequestCmd(CapabilityInformation capabilityInformation, uint8_t hoppingSequenceId, uint16_t channelOffset,
-                                       NOT_IMPLEMENTED_t extendedDsmeGtsAllocation)
-        : AssociateRequestCmd(capabilityInformation), hoppingSequenceId(hoppingSequenceId), channelOffset(channelOffset) {
+    explicit DSMEAssociationRequestCmd(CapabilityInformation capabilityInformation, uint8_t hoppingSequenceId, uint16_t channelOffset, bool dsmeAssociation,
+                                       Direction direction, bool gtsAllocationExtension)
+        : AssociateRequestCmd(capabilityInformation),
+          hoppingSequenceId(hoppingSequenceId),
+          channelOffset(channelOffset),
+          extendedDsmeGtsAllocation((dsmeAssociation ? DSME_ASSOCIATION : 0) | (direction == RX ? DIRECTION_RX : 0)),
+          gtsAllocationExtension(gtsAllocationExtension) {
     }
 
     uint8_t getHoppingSequenceId() const {
@@ -64,8 +72,18 @@ public:
         return this->channelOffset;
     }
 
-    NOT_IMPLEMENTED_t getExtendedDsmeGtsAllocation() const {
-        return this->extendedDsmeGtsAllocation;
+    /**
+     * True if the device requests a GTS together with the association
+     */
+    bool isDsmeAssociation() const {
+        return this->extendedDsmeGtsAllocation & DSME_ASSOCIATION;
+    }
+
+    /**
+     * Direction of the requested GTS as seen from the device
+     */
+    Direction getDirection() const {
+        return (this->extendedDsmeGtsAllocation & DIRECTION_RX) ? RX : TX;
     }
 
     virtual uint8_t getSerializationLength() {
@@ -73,6 +91,9 @@ public:
         size += 1; // capabilityInformation
         size += 1; // hoppingSequenceId
         size += 2; // channelOffset
+        if(gtsAllocationExtension) {
+            size += 1; // extendedDsmeGtsAllocation
+        }
         return size;
     }
 
@@ -100,12 +121,19 @@ public:
         }
         serializer << hoppingSequenceId;
         serializer << channelOffset;
+        if(gtsAllocationExtension) {
+            serializer << extendedDsmeGtsAllocation;
+        }
     }
 
 private:
+    enum : uint8_t { DSME_ASSOCIATION = 1 << 0, DIRECTION_RX = 1 << 1 };
+
     uint8_t hoppingSequenceId;
     uint16_t channelOffset;
-    NOT_IMPLEMENTED_t extendedDsmeGtsAllocation;
+    uint8_t extendedDsmeGtsAllocation;
+
+    bool gtsAllocationExtension; // not serialized
 };
 
 } /* namespace dsme */
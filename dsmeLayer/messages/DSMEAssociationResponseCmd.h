@@ -43,30 +43,44 @@
 #ifndef DSMEASSOCIATIONRESPONSECMD_H_
 #define DSMEASSOCIATIONRESPONSECMD_H_
 
+#include "../../../dsme_platform.h"
 #include "../../mac_services/DSME_Common.h"
 #include "../../mac_services/dataStructures/DSMEMessageElement.h"
 
 namespace dsme {
 class DSMEAssociationResponseCmd : public DSMEMessageElement {
 public:
-    DSMEAssociationResponseCmd(Channel_Diversity_Mode channelDiversityMode)
-        : shortAddr(0), status(AssociationStatus::Association_Status::SUCCESS), hoppingSequenceLength(0), channelDiversityMode(channelDiversityMode) {
+    /**
+     * @param gtsAllocationExtension if the non-standard GTS allocation fields are present, see macAssociationGTSAllocation
+     */
+    DSMEAssociationResponseCmd(Channel_Diversity_Mode channelDiversityMode, bool gtsAllocationExtension)
+        : shortAddr(0),
+          status(AssociationStatus::Association_Status::SUCCESS),
+          hoppingSequenceLength(0),
+          dsmeAssociation(false),
+          superframeId(0),
+          slotId(0),
+          channelIdx(0),
+          channelDiversityMode(channelDiversityMode),
+          gtsAllocationExtension(gtsAllocationExtension) {
     }
 
     DSMEAssociationResponseCmd(uint16_t shortAddr, AssociationStatus::Association_Status status, uint8_t hoppingSequenceLength,
-                               MacStaticList<uint8_t, 30> hoppingSequence, NOT_IMPLEMENTED_t allocationOrder, NOT_IMPLEMENTED_t biIdx,
-                               NOT_IMPLEMENTED_t superframeId, NOT_IMPLEMENTED_t slotId, NOT_IMPLEMENTED_t channelIdx,
-                               Channel_Diversity_Mode channelDiversityMode)
+                               const hoppingSequence_t& hoppingSequence, NOT_IMPLEMENTED_t allocationOrder, NOT_IMPLEMENTED_t biIdx, bool dsmeAssociation,
+                               uint16_t superframeId, uint8_t slotId, uint16_t channelIdx, Channel_Diversity_Mode channelDiversityMode,
+                               bool gtsAllocationExtension)
         : shortAddr(shortAddr),
           status(status),
           hoppingSequenceLength(hoppingSequenceLength),
           hoppingSequence(hoppingSequence),
           allocationOrder(allocationOrder),
           biIdx(biIdx),
+          dsmeAssociation(dsmeAssociation && gtsAllocationExtension),
           superframeId(superframeId),
           slotId(slotId),
           channelIdx(channelIdx),
-          channelDiversityMode(channelDiversityMode) {
+          channelDiversityMode(channelDiversityMode),
+          gtsAllocationExtension(gtsAllocationExtension) {
     }
 
     uint16_t getShortAddr() const {
@@ -81,7 +95,7 @@ public:
         return this->hoppingSequenceLength;
     }
 
-    MacStaticList<uint8_t, 30> getHoppingSequence() const {
+    const hoppingSequence_t& getHoppingSequence() const {
         return hoppingSequence;
     }
 
@@ -93,15 +107,26 @@ public:
         return this->biIdx;
     }
 
-    NOT_IMPLEMENTED_t getSuperframeId() const {
+    /**
+     * True if a GTS was allocated together with the association
+     */
+    bool isDsmeAssociation() const {
+        return this->dsmeAssociation;
+    }
+
+    void clearDsmeAssociation() {
+        this->dsmeAssociation = false;
+    }
+
+    uint16_t getSuperframeId() const {
         return this->superframeId;
     }
 
-    NOT_IMPLEMENTED_t getSlotId() const {
+    uint8_t getSlotId() const {
         return this->slotId;
     }
 
-    NOT_IMPLEMENTED_t getChannelIdx() const {
+    uint16_t getChannelIdx() const {
         return this->channelIdx;
     }
 
@@ -116,9 +141,14 @@ public:
         }
         // size += 1; // allocationOrder -> not implemented
         // size += 1; // biIndex -> not implemented
-        // size += 2; // superframeId -> not implemented
-        // size += 1; // slotId -> not implemented
-        // size += 2; // channelIdx -> not implemented
+        if(gtsAllocationExtension) {
+            size += 1; // dsmeAssociation
+            if(dsmeAssociation) {
+                size += 2; // superframeId
+                size += 1; // slotId
+                size += 2; // channelIdx
+            }
+        }
         return size;
     }
 
@@ -129,9 +159,27 @@ public:
         status = (AssociationStatus::Association_Status)stat;
         if(channelDiversityMode == Channel_Diversity_Mode::CHANNEL_HOPPING) {
             serializer << hoppingSequenceLength;
+            if(hoppingSequenceLength > DSME_MAX_HOPPING_SEQUENCE_LENGTH) {
+                // WARNING this is safety and security relevant, because the length might stem from incoming message content
+                hoppingSequenceLength = DSME_MAX_HOPPING_SEQUENCE_LENGTH;
+            }
             hoppingSequence.setLength(hoppingSequenceLength);
             for(int i = 0; i < hoppingSequenceLength; i++) {
-                serializer << hoppingSequence[i];
+                /* the standard encodes every entry in one octet, the radio only supports 8 bit channel numbers anyway */
+                DSME_ASSERT(serializer.getType() == DESERIALIZATION || hoppingSequence[i] <= UINT8_MAX);
+                uint8_t channel = hoppingSequence[i];
+                serializer << channel;
+                hoppingSequence[i] = channel;
+            }
+        }
+        if(gtsAllocationExtension) {
+            uint8_t allocation = dsmeAssociation;
+            serializer << allocation;
+            dsmeAssociation = allocation;
+            if(dsmeAssociation) {
+                serializer << superframeId;
+                serializer << slotId;
+                serializer << channelIdx;
             }
         }
     }
@@ -140,14 +188,16 @@ private:
     uint16_t shortAddr;
     AssociationStatus::Association_Status status;
     uint8_t hoppingSequenceLength;
-    MacStaticList<uint8_t, 30> hoppingSequence;
+    hoppingSequence_t hoppingSequence;
     NOT_IMPLEMENTED_t allocationOrder;
     NOT_IMPLEMENTED_t biIdx;
-    NOT_IMPLEMENTED_t superframeId;
-    NOT_IMPLEMENTED_t slotId;
-    NOT_IMPLEMENTED_t channelIdx;
+    bool dsmeAssociation;
+    uint16_t superframeId;
+    uint8_t slotId;
+    uint16_t channelIdx;
 
     Channel_Diversity_Mode channelDiversityMode; // not serialized
+    bool gtsAllocationExtension;                 // not serialized
 };
 
 } /* namespace dsme */
@@ -47,6 +47,7 @@
 #include "../../mac_services/DSME_Common.h"
 #include "../../mac_services/dataStructures/IEEE802154MacAddress.h"
 #include "../../mac_services/dataStructures/Serializer.h"
+#include "../../mac_services/pib/dsme_phy_constants.h"
 
 namespace dsme {
 
@@ -61,7 +62,13 @@ void IEEE802154eMACHeader::serialize(Serializer& serializer) {
          * Use the member deserializeFrom(...) instead.
          */
         const uint8_t* data = serializer.getDataRef();
-        bool success = this->deserializeFrom(data, 127);
+        bool success;
+        if(serializer.isLengthKnown()) {
+            success = this->deserializeFrom(data, serializer.getRemainingLength());
+        } else {
+            /* '-> without the end of the frame, header IEs cannot be bounded and are left to the payload */
+            success = this->deserializeFixedFieldsFrom(data, aMaxPHYPacketSize);
+        }
         serializer.getDataRef() += getSerializationLength();
         DSME_ASSERT(success);
     }
@@ -177,9 +184,40 @@ void IEEE802154eMACHeader::serializeTo(uint8_t*& buffer) {
     } else if(sourceAddressLength() == 8) {
         buffer << srcAddr;
     }
+
+    /* serialize header IEs */
+    if(timeCorrectionPresent) {
+        /* descriptor: length (7 bit), element ID (8 bit), type 0 */
+        uint16_t descriptor = 2 | (TIME_CORRECTION << 7);
+        *(buffer++) = descriptor & 0xFF;
+        *(buffer++) = descriptor >> 8;
+
+        /* time synchronization information (12 bit, two's complement), ACK/NACK (bit 15) */
+        uint16_t content = ((uint16_t)timeCorrection & 0x0FFF) | (timeCorrectionNack ? 0x8000 : 0);
+        *(buffer++) = content & 0xFF;
+        *(buffer++) = content >> 8;
+
+        if(headerIELength > 4) {
+            descriptor = (HEADER_TERMINATION_2 << 7);
+            *(buffer++) = descriptor & 0xFF;
+            *(buffer++) = descriptor >> 8;
+        }
+    }
 }
 
 bool IEEE802154eMACHeader::deserializeFrom(const uint8_t*& buffer, uint8_t payloadLength) {
+    if(!deserializeFixedFieldsFrom(buffer, payloadLength)) {
+        return false;
+    }
+
+    if(this->frameControl.ieListPresent && isVersion2015()) {
+        deserializeHeaderIEsFrom(buffer, payloadLength - getSerializationLength());
+    }
+
+    return true;
+}
+
+bool IEEE802154eMACHeader::deserializeFixedFieldsFrom(const uint8_t*& buffer, uint8_t payloadLength) {
     if(payloadLength < 2) {
         return false;
     }
@@ -188,6 +226,8 @@ bool IEEE802154eMACHeader::deserializeFrom(const uint8_t*& buffer, uint8_t paylo
     uint8_t fcLow = *(buffer++);
     uint8_t fcHigh = *(buffer++);
     this->setFrameControl(fcLow, fcHigh);
+    this->timeCorrectionPresent = false;
+    this->headerIELength = 0;
 
     // LOG_INFO("RX " << this->destinationAddressLength() << " " << this->sourceAddressLength() << " " << this->hasDestinationPANId() << " " <<
     // this->hasSourcePANId() << " " << this->frameControl.panIDCompression);
@@ -240,4 +280,35 @@ bool IEEE802154eMACHeader::deserializeFrom(const uint8_t*& buffer, uint8_t paylo
     return true;
 }
 
+void IEEE802154eMACHeader::deserializeHeaderIEsFrom(const uint8_t*& buffer, uint8_t remaining) {
+    while(remaining >= 2) {
+        uint16_t descriptor = *(buffer) | (*(buffer + 1) << 8);
+        uint8_t length = descriptor & 0x7F;
+        uint8_t elementID = (descriptor >> 7) & 0xFF;
+
+        if((descriptor & 0x8000) || length + 2 > remaining) {
+            /* '-> not a header IE or truncated, leave the rest to the payload */
+            break;
+        }
+
+        buffer += 2;
+        remaining -= 2;
+        this->headerIELength += 2;
+
+        if(elementID == HEADER_TERMINATION_1 || elementID == HEADER_TERMINATION_2) {
+            break;
+        } else if(elementID == TIME_CORRECTION && length == 2) {
+            uint16_t content = *(buffer) | (*(buffer + 1) << 8);
+            this->timeCorrectionPresent = true;
+            this->timeCorrectionNack = (content & 0x8000) != 0;
+            /* sign extension of the 12 bit value */
+            this->timeCorrection = (int16_t)(content << 4) >> 4;
+        }
+
+        buffer += length;
+        remaining -= length;
+        this->headerIELength += length;
+    }
+}
+
 } /* namespace dsme */
@@ -63,6 +63,11 @@ public:
 
     enum PANID { BROADCAST_PAN = 0xFFFF };
 
+    /**
+     * See IEEE 802.15.4-2015 7.4.2, Table 7-7
+     */
+    enum HeaderIEElementID : uint8_t { TIME_CORRECTION = 0x1e, HEADER_TERMINATION_1 = 0x7e, HEADER_TERMINATION_2 = 0x7f };
+
     /**
      * See IEEE 802.15.4e-2012 5.2.1.1, Figure 36
      */
@@ -106,6 +111,14 @@ public:
 
         creationTime = 0;
 
+        criticalEvent = false;
+        criticalEventDeadline = 0;
+
+        timeCorrectionPresent = false;
+        timeCorrection = 0;
+        timeCorrectionNack = false;
+        headerIELength = 0;
+
         hasDstPAN = false;
         hasSrcPAN = false;
 
@@ -183,6 +196,18 @@ public:
         frameControl.ackRequest = ar;
     }
 
+    void setFramePending(bool fp) {
+        if(frameControl.framePending != fp) {
+            /* '-> keeps a finalized header (e.g. the ACK template) if nothing changes */
+            finalized = false;
+            frameControl.framePending = fp;
+        }
+    }
+
+    bool isFramePending() const {
+        return frameControl.framePending;
+    }
+
     bool isAckRequested() const {
         return frameControl.ackRequest;
     }
@@ -207,6 +232,14 @@ public:
         seqNum = seq;
     }
 
+    /**
+     * Replaces the sequence number of a header that is otherwise unchanged, e.g. of the reused ACK.
+     * The sequence number has no influence on finalize(), so a finalized header stays finalized.
+     */
+    void patchSequenceNumber(uint8_t seq) {
+        seqNum = seq;
+    }
+
     uint8_t getSequenceNumber() const {
         return seqNum;
     }
@@ -239,6 +272,47 @@ public:
         this->frameControl.ieListPresent = present;
     }
 
+    /**
+     * Adds a Time Correction IE (IEEE 802.15.4-2015 7.4.2.7), only available for the 2015 frame version.
+     * @param microseconds expected minus actual arrival time of the acknowledged frame, limited to +-2047 us
+     */
+    void setTimeCorrection(int16_t microseconds, bool nack) {
+        finalized = false;
+        if(microseconds > TIME_CORRECTION_MAX) {
+            microseconds = TIME_CORRECTION_MAX;
+        } else if(microseconds < -TIME_CORRECTION_MAX) {
+            microseconds = -TIME_CORRECTION_MAX;
+        }
+        this->timeCorrectionPresent = true;
+        this->timeCorrection = microseconds;
+        this->timeCorrectionNack = nack;
+        this->frameControl.frameVersion = IEEE802154_2015;
+        this->frameControl.ieListPresent = 1;
+        /* a payload following the header IEs has to be separated by a termination IE */
+        this->headerIELength = 2 + 2 + ((this->frameControl.frameType == ACKNOWLEDGEMENT) ? 0 : 2);
+    }
+
+    void clearTimeCorrection() {
+        if(this->timeCorrectionPresent) {
+            finalized = false;
+            this->timeCorrectionPresent = false;
+            this->frameControl.ieListPresent = 0;
+            this->headerIELength = 0;
+        }
+    }
+
+    bool hasTimeCorrection() const {
+        return this->timeCorrectionPresent;
+    }
+
+    int16_t getTimeCorrection() const {
+        return this->timeCorrection;
+    }
+
+    bool isTimeCorrectionNack() const {
+        return this->timeCorrectionNack;
+    }
+
     void setSeqNumSuppression(bool suppression) {
         finalized = false;
         this->frameControl.seqNumSuppression = suppression;
@@ -320,6 +394,20 @@ public:
         this->creationTime = symbols;
     }
 
+    /* PRIORITY CHANNEL ACCESS, not transmitted */
+    void setCriticalEventDeadline(uint32_t symbols) {
+        this->criticalEvent = true;
+        this->criticalEventDeadline = symbols;
+    }
+
+    bool isCriticalEvent() const {
+        return this->criticalEvent;
+    }
+
+    bool isCriticalEventExpired(uint32_t now) const {
+        return this->criticalEvent && (int32_t)(now - this->criticalEventDeadline) >= 0;
+    }
+
 private:
     FrameControl frameControl;
 
@@ -339,8 +427,19 @@ private:
 
     bool finalized;
 
+    /* HEADER IEs, only the Time Correction IE is supported */
+    static constexpr int16_t TIME_CORRECTION_MAX = 0x7ff;
+
+    bool timeCorrectionPresent;
+    int16_t timeCorrection; // in microseconds
+    bool timeCorrectionNack;
+    uint8_t headerIELength; // including the termination IE, if any
+
     uint32_t creationTime;  // STATISTICS
 
+    bool criticalEvent;
+    uint32_t criticalEventDeadline;
+
     void finalize();
 
 public:
@@ -354,6 +453,18 @@ public:
         return this->frameControl.dstAddrMode != NO_ADDRESS;
     }
 
+    inline FrameVersion getFrameVersion() const {
+        return this->frameControl.frameVersion;
+    }
+
+    void setFrameVersion(FrameVersion version) {
+        if(this->frameControl.frameVersion != version) {
+            /* '-> keeps a finalized header (e.g. the ACK template) if nothing changes */
+            finalized = false;
+            this->frameControl.frameVersion = version;
+        }
+    }
+
     inline bool isVersion2015() const {
         return this->frameControl.frameVersion == IEEE802154_2015;
     }
@@ -442,9 +553,10 @@ public:
             size += this->sourceAddressLength(); // source address
 
             size += 0; // security
-            size += 0; // IEs
         }
 
+        size += headerIELength; // IEs
+
         return size;
     }
 
@@ -452,6 +564,11 @@ public:
 
     bool deserializeFrom(const uint8_t*& buffer, uint8_t payloadLength);
     void serializeTo(uint8_t*& buffer);
+
+private:
+    /* everything up to the header IEs */
+    bool deserializeFixedFieldsFrom(const uint8_t*& buffer, uint8_t payloadLength);
+    void deserializeHeaderIEsFrom(const uint8_t*& buffer, uint8_t remaining);
 };
 
 } /* namespace dsme */
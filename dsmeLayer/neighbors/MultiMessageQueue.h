@@ -45,6 +45,7 @@
 
 /* INCLUDES ******************************************************************/
 
+#include "../../../dsme_platform.h"
 #include "../../helper/Integers.h"
 #include "./MessageQueueEntry.h"
 #include "./NeighborListEntry.h"
@@ -96,6 +97,15 @@ public:
      */
     void push_back(NeighborListEntry<T>& neighbor, T* msg);
 
+    /**
+     * Adds a new message in front of the queue of a neighbor
+     * -> time: O(1)
+     * @param neighbor the neighbor the message belongs to
+     * @param msg pointer to the message, ownership STAYS with caller
+     * @param if true, the message is inserted behind the first message, e.g. if that is currently transmitted
+     */
+    void push_front(NeighborListEntry<T>& neighbor, T* msg, bool keepFront);
+
     /**
      * Gets and removes the first (oldest) element of the queue of a neighbor, nullptr if not existent
      * -> time: O(1)
@@ -181,6 +191,45 @@ void MultiMessageQueue<T, S>::push_back(NeighborListEntry<T>& neighbor, T* msg)
     neighbor.queueSize++;
 }
 
+template <typename T, uint8_t S>
+void MultiMessageQueue<T, S>::push_front(NeighborListEntry<T>& neighbor, T* msg, bool keepFront) {
+    if(neighbor.queueSize == 0 || (keepFront && neighbor.queueSize == 1)) {
+        /* '-> same as appending */
+        push_back(neighbor, msg);
+        return;
+    }
+
+    if(this->full) {
+        /* '-> all slots are used */
+        DSME_ASSERT(false);
+        return;
+    }
+
+    MessageQueueEntry<T>* entry = this->freeFront;
+
+    if(this->freeFront == this->freeBack) {
+        /* '-> this was the last free spot */
+        this->freeFront = nullptr;
+        this->freeBack = nullptr;
+        this->full = true;
+    } else {
+        /* '-> still multiple empty spots left */
+        this->freeFront = this->freeFront->next;
+    }
+
+    entry->value = msg;
+
+    if(keepFront) {
+        entry->next = neighbor.messageFront->next;
+        neighbor.messageFront->next = entry;
+    } else {
+        entry->next = neighbor.messageFront;
+        neighbor.messageFront = entry;
+    }
+
+    neighbor.queueSize++;
+}
+
 template <typename T, uint8_t S>
 T* MultiMessageQueue<T, S>::pop_front(NeighborListEntry<T>& neighbor) {
     if(neighbor.queueSize > 0) {
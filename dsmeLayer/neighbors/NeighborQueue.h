@@ -63,8 +63,9 @@ class IDSMEMessage;
 
 /*
  * @template-param N maximum number of neighbors
+ * @template-param S number of messages shared by all neighbors
  */
-template <uint8_t N>
+template <uint8_t N, uint8_t S = TOTAL_GTS_QUEUE_SIZE>
 class NeighborQueue {
 public:
     typedef RBTree<NeighborListEntry<IDSMEMessage>, IEEE802154MacAddress>::iterator iterator;
@@ -103,6 +104,8 @@ public:
 
     void pushBack(iterator& neighbor, IDSMEMessage* msg);
 
+    void pushFront(iterator& neighbor, IDSMEMessage* msg, bool keepFront);
+
     void flushQueues(bool keepFront);
 
     bool isQueueFull() const {
@@ -110,24 +113,24 @@ public:
     }
 
 private:
-    MultiMessageQueue<IDSMEMessage, TOTAL_GTS_QUEUE_SIZE> queue;
+    MultiMessageQueue<IDSMEMessage, S> queue;
     RBTree<NeighborListEntry<IDSMEMessage>, IEEE802154MacAddress> neighbors;
 };
 
 /* FUNCTION DEFINITIONS ******************************************************/
 
-template <uint8_t N>
-typename NeighborQueue<N>::iterator NeighborQueue<N>::begin() {
+template <uint8_t N, uint8_t S>
+typename NeighborQueue<N, S>::iterator NeighborQueue<N, S>::begin() {
     return neighbors.begin();
 }
 
-template <uint8_t N>
-const typename NeighborQueue<N>::iterator NeighborQueue<N>::end() const {
+template <uint8_t N, uint8_t S>
+const typename NeighborQueue<N, S>::iterator NeighborQueue<N, S>::end() const {
     return neighbors.end();
 }
 
-template <uint8_t N>
-void NeighborQueue<N>::addNeighbor(Neighbor& neighbor) {
+template <uint8_t N, uint8_t S>
+void NeighborQueue<N, S>::addNeighbor(Neighbor& neighbor) {
     if(neighbors.size() < N) {
         neighbors.insert(NeighborListEntry<IDSMEMessage>(neighbor), neighbor.address);
         return;
@@ -136,8 +139,8 @@ void NeighborQueue<N>::addNeighbor(Neighbor& neighbor) {
     }
 }
 
-template <uint8_t N>
-void NeighborQueue<N>::eraseNeighbor(iterator& neighbor) {
+template <uint8_t N, uint8_t S>
+void NeighborQueue<N, S>::eraseNeighbor(iterator& neighbor) {
     if(neighbor != neighbors.end()) {
         queue.flush(*neighbor, false);
         neighbors.remove(neighbor);
@@ -145,18 +148,18 @@ void NeighborQueue<N>::eraseNeighbor(iterator& neighbor) {
     return;
 }
 
-template <uint8_t N>
-neighbor_size_t NeighborQueue<N>::getNumNeighbors() const {
+template <uint8_t N, uint8_t S>
+neighbor_size_t NeighborQueue<N, S>::getNumNeighbors() const {
     return neighbors.size();
 }
 
-template <uint8_t N>
-typename NeighborQueue<N>::iterator NeighborQueue<N>::findByAddress(const IEEE802154MacAddress& address) {
+template <uint8_t N, uint8_t S>
+typename NeighborQueue<N, S>::iterator NeighborQueue<N, S>::findByAddress(const IEEE802154MacAddress& address) {
     return neighbors.find(address);
 }
 
-template <uint8_t N>
-queue_size_t NeighborQueue<N>::getPacketsInQueue(const iterator& neighbor) const {
+template <uint8_t N, uint8_t S>
+queue_size_t NeighborQueue<N, S>::getPacketsInQueue(const iterator& neighbor) const {
     if(neighbor != end()) {
         return neighbor->queueSize;
     } else {
@@ -164,29 +167,35 @@ queue_size_t NeighborQueue<N>::getPacketsInQueue(const iterator& neighbor) const
     }
 }
 
-template <uint8_t N>
-bool NeighborQueue<N>::isQueueEmpty(iterator& neighbor) {
+template <uint8_t N, uint8_t S>
+bool NeighborQueue<N, S>::isQueueEmpty(iterator& neighbor) {
     return (neighbor->queueSize == 0);
 }
 
-template <uint8_t N>
-IDSMEMessage* NeighborQueue<N>::front(iterator& neighbor) {
+template <uint8_t N, uint8_t S>
+IDSMEMessage* NeighborQueue<N, S>::front(iterator& neighbor) {
     return queue.front(*neighbor);
 }
 
-template <uint8_t N>
-IDSMEMessage* NeighborQueue<N>::popFront(iterator& neighbor) {
+template <uint8_t N, uint8_t S>
+IDSMEMessage* NeighborQueue<N, S>::popFront(iterator& neighbor) {
     return queue.pop_front(*neighbor);
 }
 
-template <uint8_t N>
-void NeighborQueue<N>::pushBack(iterator& neighbor, IDSMEMessage* msg) {
+template <uint8_t N, uint8_t S>
+void NeighborQueue<N, S>::pushBack(iterator& neighbor, IDSMEMessage* msg) {
     queue.push_back(*neighbor, msg);
     return;
 }
 
-template <uint8_t N>
-void NeighborQueue<N>::flushQueues(bool keepFront) {
+template <uint8_t N, uint8_t S>
+void NeighborQueue<N, S>::pushFront(iterator& neighbor, IDSMEMessage* msg, bool keepFront) {
+    queue.push_front(*neighbor, msg, keepFront);
+    return;
+}
+
+template <uint8_t N, uint8_t S>
+void NeighborQueue<N, S>::flushQueues(bool keepFront) {
     for(iterator i = neighbors.begin(); i != neighbors.end(); ++i) {
         queue.flush(*i, keepFront);
     }
@@ -44,6 +44,7 @@
 #define DSMEBUFFEREDMULTIFSM_H_
 
 #include "./DSMEFSM.h"
+#include "./DSMELockFreeRingbuffer.h"
 #include "./DSMERingbuffer.h"
 #include "./Integers.h"
 
@@ -90,6 +91,22 @@ public:
     bool dispatch(int8_t fsmId, uint16_t signal, Args&... args) {
         DSME_ASSERT(fsmId >= 0 && fsmId <= N);
 
+#ifdef DSME_LOCK_FREE_QUEUES
+        E event;
+        event.setFsmId(fsmId);
+        event.fill(signal, args...);
+        bool canAdd = this->eventBuffer.push(event);
+        DSME_ASSERT(canAdd); // TODO: Remove after testing? Should never trigger when S is chosen correctly.
+
+        /* orders the push before reading the flag, pairs with the fence in runUntilFinished */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(this->dispatchBusy.exchange(true, std::memory_order_acquire)) {
+            /* '-> handled by the running dispatch */
+            return canAdd;
+        }
+        runUntilFinished();
+        return true;
+#else
         bool canAdd;
         bool isBusy;
         bool returnValue;
@@ -119,6 +136,7 @@ public:
         }
 
         return returnValue;
+#endif
     }
 
     inline fsmReturnStatus transition(int8_t fsmId, state_t next) {
@@ -137,38 +155,62 @@ public:
     }
 
 private:
+#ifdef DSME_LOCK_FREE_QUEUES
+    void runUntilFinished() {
+        do {
+            E* currentEvent;
+            while((currentEvent = this->eventBuffer.front()) != nullptr) {
+                processEvent(currentEvent);
+                this->eventBuffer.pop();
+            }
+            this->dispatchBusy.store(false, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            /* an event pushed after the buffer was found empty but before the flag was cleared would be stuck otherwise */
+        } while(!this->eventBuffer.isEmpty() && !this->dispatchBusy.exchange(true, std::memory_order_acquire));
+    }
+#else
     void runUntilFinished() {
         while(!eventBuffer.isEmpty()) {
             E* currentEvent = this->eventBuffer.front();
+            processEvent(currentEvent);
+            this->eventBuffer.pop();
+        }
+        dispatchBusy = false;
+        return;
+    }
+#endif
 
-            int8_t fsmId = currentEvent->getFsmId();
-            state_t state = states[fsmId];
+    void processEvent(E* currentEvent) {
+        int8_t fsmId = currentEvent->getFsmId();
+        state_t state = states[fsmId];
 
-            state_t s = state;
-            fsmReturnStatus r = (((C*)this)->*state)(*currentEvent);
+        state_t s = state;
+        fsmReturnStatus r = (((C*)this)->*state)(*currentEvent);
 
-            while(r == FSM_TRANSITION) {
-                /* call the exit action from last state, reuse the already processed 'currentEvent' to deliver this */
-                currentEvent->signal = E::EXIT_SIGNAL;
-                r = (((C*)this)->*s)(*currentEvent);
-                DSME_ASSERT(r != FSM_TRANSITION);
+        while(r == FSM_TRANSITION) {
+            /* call the exit action from last state, reuse the already processed 'currentEvent' to deliver this */
+            currentEvent->signal = E::EXIT_SIGNAL;
+            r = (((C*)this)->*s)(*currentEvent);
+            DSME_ASSERT(r != FSM_TRANSITION);
 
-                state = states[fsmId];
-                s = state;
+            state = states[fsmId];
+            s = state;
 
-                /* call entry action of new state, reuse the already processed 'currentEvent' to deliver this */
-                currentEvent->signal = E::ENTRY_SIGNAL;
-                r = (((C*)this)->*state)(*currentEvent);
-            }
-            this->eventBuffer.pop();
+            /* call entry action of new state, reuse the already processed 'currentEvent' to deliver this */
+            currentEvent->signal = E::ENTRY_SIGNAL;
+            r = (((C*)this)->*state)(*currentEvent);
         }
-        dispatchBusy = false;
-        return;
     }
 
     state_t states[N + 1];
+#ifdef DSME_LOCK_FREE_QUEUES
+    std::atomic<bool> dispatchBusy;
+    DSMEMPSCRingBuffer<E, S> eventBuffer;
+#else
     bool dispatchBusy;
     DSMERingBuffer<E, S> eventBuffer;
+#endif
 };
 
 } /* namespace dsme */
@@ -0,0 +1,218 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DSMELOCKFREERINGBUFFER_H_
+#define DSMELOCKFREERINGBUFFER_H_
+
+#include <atomic>
+
+#include "../../dsme_settings.h"
+#include "./DSMERingbuffer.h"
+#include "./Integers.h"
+
+/**
+ * Optional lock-free event handoff.
+ *
+ * If DSME_LOCK_FREE_QUEUES is defined (e.g. in dsme_settings.h), the event buffers of the buffered FSMs and the frames
+ * received by the AckLayer are handed over between interrupts and threads with C++11 atomics instead of disabling the
+ * interrupts for every access.
+ * This requires lock-free std::atomic operations for 16 bit values and booleans on the target.
+ */
+
+namespace dsme {
+
+/**
+ * Ring buffer for exactly one producer and one consumer with the same interface as DSMERingBuffer,
+ * e.g. to pass received messages from the radio interrupt to the thread running the DSME layer (see AckLayer).
+ * The producer calls isFull, freeElement and pushFreeElement, the consumer isEmpty, front and pop.
+ */
+template <typename T, ringbuffer_size_t N>
+class DSMESPSCRingBuffer {
+public:
+    DSMESPSCRingBuffer() : buffer{}, head(0), tail(0) {
+    }
+
+    bool isEmpty() const {
+        return this->head.load(std::memory_order_relaxed) == this->tail.load(std::memory_order_acquire);
+    }
+
+    bool isFull() const {
+        return advance(this->tail.load(std::memory_order_relaxed)) == this->head.load(std::memory_order_acquire);
+    }
+
+    T* front() {
+        return &(this->buffer[this->head.load(std::memory_order_relaxed)]);
+    }
+
+    void pop() {
+        /* '-> releases the element to the producer */
+        this->head.store(advance(this->head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    T* freeElement() {
+        return &(this->buffer[this->tail.load(std::memory_order_relaxed)]);
+    }
+
+    void pushFreeElement() {
+        /* '-> publishes the element to the consumer */
+        this->tail.store(advance(this->tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    ringbuffer_size_t length() const {
+        uint16_t h = this->head.load(std::memory_order_acquire);
+        uint16_t t = this->tail.load(std::memory_order_acquire);
+        return (t + N + 1 - h) % (N + 1);
+    }
+
+private:
+    static uint16_t advance(uint16_t index) {
+        return (index + 1) % (N + 1);
+    }
+
+    /* one element stays unused to distinguish a full from an empty buffer */
+    T buffer[N + 1];
+    std::atomic<uint16_t> head; // written by the consumer only
+    std::atomic<uint16_t> tail; // written by the producer only
+};
+
+/**
+ * Bounded ring buffer for any number of producers and exactly one consumer, e.g. for the event buffers of the FSMs
+ * that are dispatched from interrupts and from the thread running the DSME layer.
+ * Every element carries a sequence number that tells whether it is free, reserved or published,
+ * so a producer that is interrupted while filling its element does not block the other producers.
+ */
+template <typename T, ringbuffer_size_t N>
+class DSMEMPSCRingBuffer {
+public:
+    DSMEMPSCRingBuffer() : enqueuePosition(0), dequeuePosition(0) {
+        for(uint16_t i = 0; i < N; i++) {
+            this->cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Called by the producers
+     * @return false if the buffer is full
+     */
+    bool push(const T& element) {
+        Cell* cell;
+        uint16_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+        while(true) {
+            cell = &(this->cells[position % N]);
+            int16_t difference = distance(cell->sequence.load(std::memory_order_acquire), position);
+            if(difference == 0) {
+                /* '-> the element is free, try to reserve it */
+                if(this->enqueuePosition.compare_exchange_weak(position, wrap(position + 1), std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if(difference < 0) {
+                /* '-> the element is still used by the consumer */
+                return false;
+            } else {
+                /* '-> another producer was faster */
+                position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->element = element;
+        cell->sequence.store(wrap(position + 1), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Called by the consumer, also true if the next element is reserved but not yet published
+     */
+    bool isEmpty() const {
+        return front() == nullptr;
+    }
+
+    /**
+     * Called by the consumer
+     * @return the next published element or nullptr
+     */
+    T* front() const {
+        Cell& cell = this->cells[this->dequeuePosition % N];
+        if(cell.sequence.load(std::memory_order_acquire) != wrap(this->dequeuePosition + 1)) {
+            return nullptr;
+        }
+        return &(cell.element);
+    }
+
+    /**
+     * Called by the consumer after the element returned by front was processed
+     */
+    void pop() {
+        Cell& cell = this->cells[this->dequeuePosition % N];
+        /* '-> the element can be reserved again in the next round */
+        cell.sequence.store(wrap(this->dequeuePosition + N), std::memory_order_release);
+        this->dequeuePosition = wrap(this->dequeuePosition + 1);
+    }
+
+private:
+    static_assert(N > 0, "at least one element is required");
+
+    /* positions and sequence numbers wrap at a multiple of N, so the element of a position stays the same */
+    static constexpr uint16_t PERIOD = (0x8000 / N) * N;
+
+    static uint16_t wrap(uint32_t position) {
+        return position % PERIOD;
+    }
+
+    /* signed distance a - b of two wrapped positions */
+    static int16_t distance(uint16_t a, uint16_t b) {
+        int32_t d = ((int32_t)a - b + PERIOD) % PERIOD;
+        return d > PERIOD / 2 ? d - PERIOD : d;
+    }
+
+    struct Cell {
+        std::atomic<uint16_t> sequence;
+        T element;
+    };
+
+    mutable Cell cells[N];
+    std::atomic<uint16_t> enqueuePosition;
+    uint16_t dequeuePosition; // accessed by the consumer only
+};
+
+} /* namespace dsme */
+
+#endif /* DSMELOCKFREERINGBUFFER_H_ */
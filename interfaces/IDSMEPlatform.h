@@ -43,6 +43,7 @@
 #ifndef IDSMEPLATFORM_H_
 #define IDSMEPLATFORM_H_
 
+#include "../../dsme_settings.h"
 #include "../helper/DSMEDelegate.h"
 #include "../helper/Integers.h"
 #include "../mac_services/DSME_Common.h"
@@ -65,13 +66,24 @@ public:
      */
     virtual void handleReceivedMessageFromAckLayer(IDSMEMessage* message) = 0;
 
+#ifdef DSME_LOCK_FREE_QUEUES
+    /*
+     * Wakes the thread running the DSME layer that calls DSMELayer::getAckLayer().processReceivedMessages().
+     * The received messages are then handed over in a lock-free queue instead of the two functions above.
+     */
+    virtual void scheduleReceivedMessages() = 0;
+#endif
+
     /*
      * Allocate a new DSMEMessage
+     * The buffer management is up to the platform, since only it knows the concrete message type.
      */
     virtual IDSMEMessage* getEmptyMessage() = 0;
 
     /*
      * Release a DSMEMessage
+     * The library releases every message exactly once and never keeps it in more than one queue.
+     * A platform that shares frame buffers between messages has to count the references itself.
      */
     virtual void releaseMessage(IDSMEMessage* msg) = 0;
 
@@ -100,6 +112,19 @@ public:
      */
     virtual void scheduleStartOfCFP() = 0;
 
+#ifdef DSME_THREADED_UPPER_HALF
+    /*
+     * Wakes a worker thread that calls DSMELayer::getUpperHalf().process()
+     */
+    virtual void scheduleUpperHalf() = 0;
+
+    /*
+     * Serializes the upper half with the slot engine, e.g. with a mutex using priority inheritance
+     */
+    virtual void lockLowerHalf() = 0;
+    virtual void unlockLowerHalf() = 0;
+#endif
+
     /*
      * Beacons with LQI lower than this will not be considered when deciding for a coordinator to associate to
      */
@@ -43,15 +43,27 @@
 #ifndef CONFIRMBASE_H_
 #define CONFIRMBASE_H_
 
+#include "../../dsme_settings.h"
 #include "../helper/DSMEDelegate.h"
 
+#ifdef DSME_THREADED_UPPER_HALF
+#include <atomic>
+#include "../../dsme_platform.h"
+#include "../dsmeLayer/DSMEUpperHalfDispatcher.h"
+#endif
+
 namespace dsme {
 
 template <typename C>
 class ConfirmBase {
 public:
+#ifdef DSME_THREADED_UPPER_HALF
+    ConfirmBase() : confirm_received(false), last_confirm{}, upperHalf(nullptr), deliveryPosted(false) {
+    }
+#else
     ConfirmBase() : confirm_received(false), last_confirm{} {
     }
+#endif
 
     void confirm(Delegate<void(C&)> callback) {
         this->callback_confirm = callback;
@@ -72,6 +84,22 @@ public:
     void notify_confirm(C& params) {
         if(this->callback_confirm) {
             /* if callback is set, parameter will not be saved */
+#ifdef DSME_THREADED_UPPER_HALF
+            if(this->upperHalf != nullptr) {
+                if(!this->pendingConfirms.push(params)) {
+                    /* '-> the upper half lags behind, deliver synchronously instead of losing the parameters (and messages) */
+                    deliverPendingConfirms();
+                    this->callback_confirm(params);
+                    return;
+                }
+
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(!this->deliveryPosted.exchange(true, std::memory_order_acquire)) {
+                    this->upperHalf->post(DelegateFactory<ConfirmBase<C>, void>::template Create<&ConfirmBase<C>::deliverConfirms>(this));
+                }
+                return;
+            }
+#endif
             this->callback_confirm(params);
         } else {
             this->last_confirm = params;
@@ -79,11 +107,45 @@ public:
         }
     }
 
+#ifdef DSME_THREADED_UPPER_HALF
+    /* the callback is invoked by the upper half, see DSMEUpperHalfDispatcher */
+    void deferConfirm(DSMEUpperHalfDispatcher* upperHalf) {
+        this->upperHalf = upperHalf;
+    }
+#endif
+
 private:
+#ifdef DSME_THREADED_UPPER_HALF
+    void deliverConfirms() {
+        this->deliveryPosted.store(false, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        /* '-> parameters pushed from now on post another delivery, so none is left behind */
+        deliverPendingConfirms();
+    }
+
+    /* the lower half lock is held by all callers, so only one of them consumes the queue at a time */
+    void deliverPendingConfirms() {
+        C* next;
+        while((next = this->pendingConfirms.front()) != nullptr) {
+            /* '-> removed before the callback, which may push further parameters */
+            C params = *next;
+            this->pendingConfirms.pop();
+            this->callback_confirm(params);
+        }
+    }
+#endif
+
     /* confirm from lower layer received and parameters saved in last_confirm if no callback is set */
     bool confirm_received;
     C last_confirm;
     Delegate<void(C&)> callback_confirm;
+
+#ifdef DSME_THREADED_UPPER_HALF
+    DSMEUpperHalfDispatcher* upperHalf;
+    std::atomic<bool> deliveryPosted;
+    DSMEMPSCRingBuffer<C, UPPER_HALF_PRIMITIVE_QUEUE_SIZE> pendingConfirms;
+#endif
 };
 
 } /* namespace dsme */
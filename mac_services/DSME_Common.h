@@ -51,6 +51,7 @@ JUST A QUICK FIX AND NEEDS TO BE RESOLVED */
 
 #include "../helper/DSMEDelegate.h"
 #include "../helper/Integers.h"
+#include "./MacDataStructures.h"
 
 namespace dsme {
 
@@ -85,6 +86,16 @@ struct CapabilityInformation {
     bool allocateAddress : 1;
 };
 
+/** The maximum number of entries of a channel hopping sequence. */
+#ifndef DSME_MAX_HOPPING_SEQUENCE_LENGTH
+#define DSME_MAX_HOPPING_SEQUENCE_LENGTH 32
+#endif
+
+/* the association response encodes the length of the hopping sequence in one octet */
+static_assert(DSME_MAX_HOPPING_SEQUENCE_LENGTH <= UINT8_MAX, "DSME_MAX_HOPPING_SEQUENCE_LENGTH exceeds the association response encoding");
+
+typedef MacStaticList<uint16_t, DSME_MAX_HOPPING_SEQUENCE_LENGTH> hoppingSequence_t;
+
 struct HoppingDescriptor {
     uint8_t hoppingSequenceID;
     uint16_t hoppingSequenceLength;
@@ -43,15 +43,27 @@
 #ifndef INDICATIONBASE_H_
 #define INDICATIONBASE_H_
 
+#include "../../dsme_settings.h"
 #include "../helper/DSMEDelegate.h"
 
+#ifdef DSME_THREADED_UPPER_HALF
+#include <atomic>
+#include "../../dsme_platform.h"
+#include "../dsmeLayer/DSMEUpperHalfDispatcher.h"
+#endif
+
 namespace dsme {
 
 template <typename I>
 class IndicationBase {
 public:
+#ifdef DSME_THREADED_UPPER_HALF
+    IndicationBase() : indication_received(false), last_indication{}, upperHalf(nullptr), deliveryPosted(false) {
+    }
+#else
     IndicationBase() : indication_received(false), last_indication{} {
     }
+#endif
 
     void indication(Delegate<void(I&)> callback) {
         this->callback_indication = callback;
@@ -72,6 +84,22 @@ public:
     void notify_indication(I& params) {
         if(this->callback_indication) {
             /* if callback is set, parameter will not be saved */
+#ifdef DSME_THREADED_UPPER_HALF
+            if(this->upperHalf != nullptr) {
+                if(!this->pendingIndications.push(params)) {
+                    /* '-> the upper half lags behind, deliver synchronously instead of losing the parameters (and messages) */
+                    deliverPendingIndications();
+                    this->callback_indication(params);
+                    return;
+                }
+
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if(!this->deliveryPosted.exchange(true, std::memory_order_acquire)) {
+                    this->upperHalf->post(DelegateFactory<IndicationBase<I>, void>::template Create<&IndicationBase<I>::deliverIndications>(this));
+                }
+                return;
+            }
+#endif
             this->callback_indication(params);
         } else {
             this->last_indication = params;
@@ -79,11 +107,45 @@ public:
         }
     }
 
+#ifdef DSME_THREADED_UPPER_HALF
+    /* the callback is invoked by the upper half, see DSMEUpperHalfDispatcher */
+    void deferIndication(DSMEUpperHalfDispatcher* upperHalf) {
+        this->upperHalf = upperHalf;
+    }
+#endif
+
 private:
+#ifdef DSME_THREADED_UPPER_HALF
+    void deliverIndications() {
+        this->deliveryPosted.store(false, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        /* '-> parameters pushed from now on post another delivery, so none is left behind */
+        deliverPendingIndications();
+    }
+
+    /* the lower half lock is held by all callers, so only one of them consumes the queue at a time */
+    void deliverPendingIndications() {
+        I* next;
+        while((next = this->pendingIndications.front()) != nullptr) {
+            /* '-> removed before the callback, which may push further parameters */
+            I params = *next;
+            this->pendingIndications.pop();
+            this->callback_indication(params);
+        }
+    }
+#endif
+
     /* indication from lower layer received and parameters saved in last_indication if no callback is set */
     bool indication_received;
     I last_indication;
     Delegate<void(I&)> callback_indication;
+
+#ifdef DSME_THREADED_UPPER_HALF
+    DSMEUpperHalfDispatcher* upperHalf;
+    std::atomic<bool> deliveryPosted;
+    DSMEMPSCRingBuffer<I, UPPER_HALF_PRIMITIVE_QUEUE_SIZE> pendingIndications;
+#endif
 };
 
 } /* namespace dsme */
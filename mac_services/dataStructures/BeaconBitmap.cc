@@ -89,6 +89,23 @@ void BeaconBitmap::orWith(const BeaconBitmap& bitmap) {
     sdBitmap.setOperationJoin(bitmap.sdBitmap);
 }
 
+void BeaconBitmap::orWith(const uint8_t* bytes, uint16_t lengthBytes) {
+    for(uint16_t i = 0; i < lengthBytes; i++) {
+        if(bytes[i] == 0) {
+            continue;
+        }
+        for(uint8_t bit = 0; bit < 8; bit++) {
+            uint16_t position = i * 8 + bit;
+            if(position >= sdBitmap.length()) {
+                return;
+            }
+            if(bytes[i] & (1 << bit)) {
+                sdBitmap.set(position, true);
+            }
+        }
+    }
+}
+
 int32_t BeaconBitmap::getNextAllocated(uint16_t start) const {
     for(uint16_t i = start; i < sdBitmap.length(); i++) {
         if(sdBitmap.get(i)) {
@@ -104,6 +104,13 @@ public:
      */
     void orWith(const BeaconBitmap& bitmap);
 
+    /*
+     * Perform a bitwise OR with a serialized bitmap, overwrite own bits
+     * @param bytes serialized bitmap, bits exceeding the own length are ignored
+     * @param lengthBytes length of the serialized bitmap
+     */
+    void orWith(const uint8_t* bytes, uint16_t lengthBytes);
+
     /**
      * Get index of next allocated slot after start
      * @param start first index to check
@@ -68,6 +68,12 @@ void DSMEAllocationCounterTable::initialize(uint16_t numSuperFramesPerMultiSuper
     this->numGTSlotsFirstSuperframe = numGTSlotsFirstSuperframe;
     this->numGTSlotsLatterSuperframes = numGTSlotsLatterSuperframes;
     this->numChannels = numChannels;
+#ifdef DSME_STATIC_CONFIGURATION
+    DSME_ASSERT(numSuperFramesPerMultiSuperframe == static_configuration::superframesPerMultiSuperframe);
+    DSME_ASSERT(numGTSlotsFirstSuperframe == static_configuration::numGTSlots(0));
+    DSME_ASSERT(numGTSlotsLatterSuperframes == static_configuration::numGTSlots(1));
+    DSME_ASSERT(numChannels == static_configuration::numChannels);
+#endif
     bitmap.initialize((numGTSlotsFirstSuperframe + (numSuperFramesPerMultiSuperframe - 1) * numGTSlotsLatterSuperframes), false);
     this->dsme = dsme;
 }
@@ -76,7 +82,11 @@ uint16_t DSMEAllocationCounterTable::getBitmapPosition(uint8_t superframeID, uin
     if(superframeID == 0) {
         return slotID;
     } else {
+#ifdef DSME_STATIC_CONFIGURATION
+        return (static_configuration::numGTSlots(0) + (superframeID - 1) * static_configuration::numGTSlots(1)) + slotID;
+#else
         return (numGTSlotsFirstSuperframe + (superframeID - 1) * numGTSlotsLatterSuperframes) + slotID;
+#endif
     }
 }
 
@@ -191,6 +201,48 @@ bool DSMEAllocationCounterTable::isAllocated(uint16_t superframeID, uint8_t gtSl
     return bitmap.get(getBitmapPosition(superframeID, gtSlotID));
 }
 
+void DSMEAllocationCounterTable::setNumGTSlotsLatterSuperframes(uint8_t numGTSlotsLatterSuperframes) {
+#ifdef DSME_STATIC_CONFIGURATION
+    /* '-> the slot structure is fixed at compile time */
+    DSME_ASSERT(false);
+#endif
+    DSME_ASSERT(this->numGTSlotsLatterSuperframes == dsme->getMAC_PIB().helper.getNumGTSlots(1));
+
+    const int16_t shift = (int16_t)numGTSlotsLatterSuperframes - this->numGTSlotsLatterSuperframes;
+    if(shift == 0) {
+        return;
+    }
+
+    /* remove the allocations that overlap with the CAP afterwards */
+    bool removed = true;
+    while(removed) {
+        removed = false;
+        for(iterator it = act.begin(); it != act.end(); ++it) {
+            if(it->superframeID > 0 && it->slotID + shift < 0) {
+                remove(it);
+                removed = true;
+                break;
+            }
+        }
+    }
+
+    /* all GT slots of a superframe are shifted equally, so the order is kept and the keys can be changed in place */
+    for(iterator it = act.begin(); it != act.end(); ++it) {
+        if(it->superframeID > 0) {
+            it->slotID += shift;
+            it.node()->key.gtSlotID += shift;
+        }
+    }
+
+    this->numGTSlotsLatterSuperframes = numGTSlotsLatterSuperframes;
+    uint16_t numGTSlots = numGTSlotsFirstSuperframe + (numSuperFramesPerMultiSuperframe - 1) * numGTSlotsLatterSuperframes;
+    DSME_ASSERT(numGTSlots <= ACT_BITMAP_SIZE);
+    bitmap.initialize(numGTSlots, false);
+    for(iterator it = act.begin(); it != act.end(); ++it) {
+        bitmap.set(getBitmapPosition(it->superframeID, it->slotID), true);
+    }
+}
+
 uint16_t DSMEAllocationCounterTable::getNumAllocatedGTS(uint16_t address, Direction direction) {
     int d = (direction == TX) ? 0 : 1;
     RBTree<uint16_t, uint16_t>::iterator numSlotIt = numAllocatedSlots[d].find(address);
@@ -287,3 +339,57 @@ void DSMEAllocationCounterTable::setACTState(DSMESABSpecification& subBlock, ACT
         }
     }
 }
+
+uint16_t DSMEAllocationCounterTable::getSerializationLength() const {
+    return 2 + act.size() * SERIALIZED_ELEMENT_LENGTH;
+}
+
+namespace dsme {
+
+Serializer& operator<<(Serializer& serializer, DSMEAllocationCounterTable& act) {
+    uint16_t numElements = act.act.size();
+    serializer << numElements;
+
+    if(serializer.getType() == SERIALIZATION) {
+        for(DSMEAllocationCounterTable::iterator it = act.begin(); it != act.end(); ++it) {
+            uint16_t superframeID = it->getSuperframeID();
+            uint8_t slotID = it->getGTSlotID();
+            uint8_t channel = it->getChannel();
+            uint8_t flags = (it->getDirection() == RX ? 1 : 0) | (it->getState() << 1);
+            uint16_t address = it->getAddress();
+            serializer << superframeID;
+            serializer << slotID;
+            serializer << channel;
+            serializer << flags;
+            serializer << address;
+        }
+    } else {
+        act.clear();
+        for(uint16_t i = 0; i < numElements; i++) {
+            uint16_t superframeID;
+            uint8_t slotID;
+            uint8_t channel;
+            uint8_t flags;
+            uint16_t address;
+            serializer << superframeID;
+            serializer << slotID;
+            serializer << channel;
+            serializer << flags;
+            serializer << address;
+
+            Direction direction = (flags & 1) ? RX : TX;
+            ACTState state = (ACTState)(flags >> 1);
+            if(superframeID >= act.numSuperFramesPerMultiSuperframe || state >= REMOVED ||
+               slotID >= (superframeID == 0 ? act.numGTSlotsFirstSuperframe : act.numGTSlotsLatterSuperframes) ||
+               act.isAllocated(superframeID, slotID)) {
+                LOG_ERROR("Skipping invalid stored ACT element " << superframeID << "," << (uint16_t)slotID);
+                continue;
+            }
+            act.add(superframeID, slotID, channel, direction, address, state);
+        }
+    }
+
+    return serializer;
+}
+
+} /* namespace dsme */
@@ -45,10 +45,12 @@
 
 #include "../../../dsme_settings.h"
 #include "../../interfaces/IDSMEPlatform.h"
+#include "../pib/dsme_static_configuration.h"
 #include "./ACTElement.h"
 #include "./DSMEBitVector.h"
 #include "./DSMESABSpecification.h"
 #include "./RBTree.h"
+#include "./Serializer.h"
 
 namespace dsme {
 
@@ -110,6 +112,14 @@ public:
 
     bool isAllocated(uint16_t superframeID, uint8_t gtSlotID) const;
 
+    /**
+     * Changes the number of GT slots of all but the first superframe, i.e. if the CAP reduction is switched.
+     * The allocations keep their slot within the superframe, so their GT slot IDs are shifted by the difference.
+     * Allocations that would be located in the CAP are removed.
+     * Has to be called before the PIB is changed.
+     */
+    void setNumGTSlotsLatterSuperframes(uint8_t numGTSlotsLatterSuperframes);
+
     uint16_t getNumAllocatedGTS(uint16_t address, Direction direction);
 
     void setACTState(DSMESABSpecification& subBlock, ACTState state, Direction direction, uint16_t deviceAddress, uint16_t channelOffset, bool useChannelOffset,
@@ -118,6 +128,19 @@ public:
                      condition_t condition, bool checkAddress = false);
     void setACTStateIfExists(DSMESABSpecification& subBlock, ACTState state, uint16_t channelOffset);
 
+    /**
+     * Number of bytes required to store the table, e.g. for a warm restart
+     */
+    uint16_t getSerializationLength() const;
+
+    static constexpr uint8_t SERIALIZED_ELEMENT_LENGTH = 7;
+
+    /**
+     * Stores or restores all elements, the idle counters are not stored.
+     * The table has to be initialized with the same slot structure before it can be restored.
+     */
+    friend Serializer& operator<<(Serializer& serializer, DSMEAllocationCounterTable& act);
+
 private:
     DSMEAllocationCounterTable(const DSMEAllocationCounterTable& other) = delete;
     uint16_t getBitmapPosition(uint8_t superframeID, uint8_t slotID) const;
@@ -127,7 +150,7 @@ private:
     uint8_t numGTSlotsLatterSuperframes;
     uint8_t numChannels;
 
-    BitVector<MAX_SUPERFRAMES_PER_MULTI_SUPERFRAME * MAX_GTSLOTS> bitmap;
+    BitVector<ACT_BITMAP_SIZE> bitmap;
     RBTree<ACTElement, ACTPosition> act;
 
     // TODO integrate this nicely into the NeighborQueue
@@ -136,6 +159,8 @@ private:
     DSMELayer* dsme;
 };
 
+Serializer& operator<<(Serializer& serializer, DSMEAllocationCounterTable& act);
+
 } /* namespace dsme */
 
 #endif /* DSMEALLOCATIONCOUNTERTABLE_H_ */
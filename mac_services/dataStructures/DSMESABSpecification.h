@@ -44,13 +44,14 @@
 #define DSMESABSPECIFICATION_H_
 
 #include "../../../dsme_settings.h"
+#include "../pib/dsme_static_configuration.h"
 #include "./DSMEBitVector.h"
 
 namespace dsme {
 
 class DSMESABSpecification {
 public:
-    typedef BitVector<MAX_GTSLOTS * MAX_CHANNELS * MAX_SAB_UNITS> SABSubBlock;
+    typedef BitVector<SAB_SUBBLOCK_SIZE> SABSubBlock;
 
     DSMESABSpecification() : subBlockIndex(0) {
     }
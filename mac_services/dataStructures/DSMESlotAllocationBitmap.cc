@@ -42,6 +42,7 @@
 
 #include "./DSMESlotAllocationBitmap.h"
 
+#include "../../../dsme_platform.h"
 #include "./DSMEBitVector.h"
 #include "./DSMESABSpecification.h"
 #include "./GTS.h"
@@ -58,6 +59,12 @@ void DSMESlotAllocationBitmap::initialize(uint16_t numSuperframesPerMultiSuperfr
     this->numGTSlotsFirstSuperframe = numGTSlotsFirstSuperframe;
     this->numGTSlotsLatterSuperframes = numGTSlotsLatterSuperframes;
     this->numChannels = numChannels;
+#ifdef DSME_STATIC_CONFIGURATION
+    DSME_ASSERT(numSuperframesPerMultiSuperframe == static_configuration::superframesPerMultiSuperframe);
+    DSME_ASSERT(numGTSlotsFirstSuperframe == static_configuration::numGTSlots(0));
+    DSME_ASSERT(numGTSlotsLatterSuperframes == static_configuration::numGTSlots(1));
+    DSME_ASSERT(numChannels == static_configuration::numChannels);
+#endif
     occupied.initialize((numGTSlotsFirstSuperframe + (numSuperframesPerMultiSuperframe - 1) * numGTSlotsLatterSuperframes) * numChannels);
     return;
 }
@@ -66,11 +73,51 @@ void DSMESlotAllocationBitmap::clear() {
     occupied.fill(false);
 }
 
+void DSMESlotAllocationBitmap::setNumGTSlotsLatterSuperframes(uint8_t numGTSlotsLatterSuperframes) {
+#ifdef DSME_STATIC_CONFIGURATION
+    /* '-> the slot structure is fixed at compile time */
+    DSME_ASSERT(false);
+#endif
+    const int16_t shift = (int16_t)numGTSlotsLatterSuperframes - this->numGTSlotsLatterSuperframes;
+    if(shift == 0) {
+        return;
+    }
+
+    BitVector<SAB_OCCUPIED_SIZE> previous = occupied;
+    uint8_t previousNumGTSlots = this->numGTSlotsLatterSuperframes;
+
+    this->numGTSlotsLatterSuperframes = numGTSlotsLatterSuperframes;
+    uint16_t numSlots = (numGTSlotsFirstSuperframe + (numSuperframesPerMultiSuperframe - 1) * numGTSlotsLatterSuperframes) * numChannels;
+    DSME_ASSERT(numSlots <= SAB_OCCUPIED_SIZE);
+    occupied.initialize(numSlots);
+
+    for(uint16_t i = 0; i < numGTSlotsFirstSuperframe * numChannels; i++) {
+        occupied.set(i, previous.get(i));
+    }
+
+    for(uint16_t superframe = 1; superframe < numSuperframesPerMultiSuperframe; superframe++) {
+        uint16_t previousOffset = (numGTSlotsFirstSuperframe + (superframe - 1) * previousNumGTSlots) * numChannels;
+        for(uint8_t slot = 0; slot < previousNumGTSlots; slot++) {
+            if(slot + shift < 0) {
+                /* '-> part of the CAP now */
+                continue;
+            }
+            for(uint8_t channel = 0; channel < numChannels; channel++) {
+                occupied.set(getSubblockOffset(superframe) + (slot + shift) * numChannels + channel, previous.get(previousOffset + slot * numChannels + channel));
+            }
+        }
+    }
+}
+
 uint16_t DSMESlotAllocationBitmap::getSubblockOffset(uint8_t subBlockIndex) const {
     if(subBlockIndex == 0) {
         return 0;
     } else {
+#ifdef DSME_STATIC_CONFIGURATION
+        return (static_configuration::numGTSlots(0) + (subBlockIndex - 1) * static_configuration::numGTSlots(1)) * static_configuration::numChannels;
+#else
         return (numGTSlotsFirstSuperframe + (subBlockIndex - 1) * numGTSlotsLatterSuperframes) * numChannels;
+#endif
     }
 }
 
@@ -97,4 +144,14 @@ bool DSMESlotAllocationBitmap::isOccupied(abs_slot_idx_t idx) {
     return occupied.get(idx);
 }
 
+uint16_t DSMESlotAllocationBitmap::getSerializationLength() const {
+    return BITVECTOR_BYTE_LENGTH(occupied.length());
+}
+
+Serializer& operator<<(Serializer& serializer, DSMESlotAllocationBitmap& sab) {
+    /* the length is given by the slot structure and not stored */
+    serializer << sab.occupied;
+    return serializer;
+}
+
 } /* namespace dsme */
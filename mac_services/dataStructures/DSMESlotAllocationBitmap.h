@@ -44,8 +44,10 @@
 #define DSMESLOTALLOCATIONBITMAP_H_
 
 #include "../../helper/Integers.h"
+#include "../pib/dsme_static_configuration.h"
 #include "./DSMESABSpecification.h"
 #include "./GTS.h"
+#include "./Serializer.h"
 
 namespace dsme {
 
@@ -60,6 +62,12 @@ public:
      */
     void clear();
 
+    /**
+     * Changes the number of GT slots of all but the first superframe, i.e. if the CAP reduction is switched.
+     * Occupied slots keep their slot within the superframe, those that would be located in the CAP are dropped.
+     */
+    void setNumGTSlotsLatterSuperframes(uint8_t numGTSlotsLatterSuperframes);
+
     /**
      * Get sub block for superframe
      */
@@ -82,16 +90,29 @@ public:
 
     bool isOccupied(abs_slot_idx_t idx);
 
+    /**
+     * Number of bytes required to store the bitmap, e.g. for a warm restart
+     */
+    uint16_t getSerializationLength() const;
+
+    /**
+     * Stores or restores the occupied slots.
+     * The bitmap has to be initialized with the same slot structure before it can be restored.
+     */
+    friend Serializer& operator<<(Serializer& serializer, DSMESlotAllocationBitmap& sab);
+
 private:
     uint16_t getSubblockOffset(uint8_t subBlockIndex) const;
 
-    BitVector<MAX_OCCUPIED_SLOTS> occupied; // occupied by neighbors
+    BitVector<SAB_OCCUPIED_SIZE> occupied; // occupied by neighbors
     uint16_t numSuperframesPerMultiSuperframe;
     uint8_t numGTSlotsFirstSuperframe;
     uint8_t numGTSlotsLatterSuperframes;
     uint8_t numChannels;
 };
 
+Serializer& operator<<(Serializer& serializer, DSMESlotAllocationBitmap& sab);
+
 } /* namespace dsme */
 
 #endif /* DSMESLOTALLOCATIONBITMAP_H_ */
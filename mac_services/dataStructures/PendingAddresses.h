@@ -44,16 +44,110 @@
 #define PENDINGADDRESSES_H_
 
 #include "../../helper/Integers.h"
+#include "./IEEE802154MacAddress.h"
+#include "./Serializer.h"
 
 namespace dsme {
 
+/**
+ * Pending address specification and address list of a beacon, see IEEE 802.15.4-2011 5.2.2.1.6 and 5.2.2.1.7.
+ * Lists the devices a coordinator holds indirect transmissions for.
+ */
 class PendingAddresses {
 public:
+    /* a beacon may list at most seven addresses, short and extended ones together */
+    static constexpr uint8_t MAX_PENDING_ADDRESSES = 7;
+
     PendingAddresses() : specByte(0) {
     }
 
+    void clear() {
+        specByte = 0;
+    }
+
+    uint8_t getNumShortAddresses() const {
+        return numShortAddrs;
+    }
+
+    uint8_t getNumExtendedAddresses() const {
+        return numExtAddrs;
+    }
+
+    bool isFull() const {
+        return numShortAddrs + numExtAddrs >= MAX_PENDING_ADDRESSES;
+    }
+
+    /**
+     * Adds a short address to the list, duplicates are ignored.
+     * \return false if the list is full
+     */
+    bool addShortAddress(uint16_t address) {
+        if(isShortAddressPending(address)) {
+            return true;
+        }
+        if(isFull()) {
+            return false;
+        }
+        shortAddresses[numShortAddrs++] = address;
+        return true;
+    }
+
+    /**
+     * Adds an extended address to the list, duplicates are ignored.
+     * \return false if the list is full
+     */
+    bool addExtendedAddress(const IEEE802154MacAddress& address) {
+        if(isExtendedAddressPending(address)) {
+            return true;
+        }
+        if(isFull()) {
+            return false;
+        }
+        extendedAddresses[numExtAddrs++] = address;
+        return true;
+    }
+
+    bool isShortAddressPending(uint16_t address) const {
+        for(uint8_t i = 0; i < numShortAddrs; i++) {
+            if(shortAddresses[i] == address) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isExtendedAddressPending(const IEEE802154MacAddress& address) const {
+        for(uint8_t i = 0; i < numExtAddrs; i++) {
+            if(extendedAddresses[i] == address) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool operator==(const PendingAddresses& other) const {
+        if(numShortAddrs != other.numShortAddrs || numExtAddrs != other.numExtAddrs) {
+            return false;
+        }
+        for(uint8_t i = 0; i < numShortAddrs; i++) {
+            if(shortAddresses[i] != other.shortAddresses[i]) {
+                return false;
+            }
+        }
+        for(uint8_t i = 0; i < numExtAddrs; i++) {
+            if(extendedAddresses[i] != other.extendedAddresses[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const PendingAddresses& other) const {
+        return !((*this) == other);
+    }
+
     uint8_t getSerializationLength() const {
-        return 1;
+        return 1 + 2 * numShortAddrs + 8 * numExtAddrs;
     }
 
 private:
@@ -67,11 +161,21 @@ private:
         uint8_t specByte;
     };
 
+    /* both counters are three bits wide, so a received list always fits even if it exceeds MAX_PENDING_ADDRESSES in total */
+    uint16_t shortAddresses[MAX_PENDING_ADDRESSES];
+    IEEE802154MacAddress extendedAddresses[MAX_PENDING_ADDRESSES];
+
     friend Serializer& operator<<(Serializer& serializer, PendingAddresses& spec);
 };
 
 inline Serializer& operator<<(Serializer& serializer, PendingAddresses& spec) {
     serializer << spec.specByte;
+    for(uint8_t i = 0; i < spec.numShortAddrs; i++) {
+        serializer << spec.shortAddresses[i];
+    }
+    for(uint8_t i = 0; i < spec.numExtAddrs; i++) {
+        serializer << spec.extendedAddresses[i];
+    }
     return serializer;
 }
 
@@ -49,7 +49,13 @@ enum serialization_type_t { SERIALIZATION, DESERIALIZATION };
 
 class Serializer {
 public:
-    Serializer(uint8_t* data, serialization_type_t type) : data(data), type(type) {
+    Serializer(uint8_t* data, serialization_type_t type) : data(data), end(nullptr), type(type) {
+    }
+
+    /**
+     * @param length number of bytes available at data, e.g. the length of a received frame
+     */
+    Serializer(uint8_t* data, serialization_type_t type, uint8_t length) : data(data), end(data + length), type(type) {
     }
 
     Serializer& operator<<(uint16_t& value) {
@@ -86,8 +92,18 @@ public:
         return type;
     }
 
+    bool isLengthKnown() const {
+        return end != nullptr;
+    }
+
+    /* only valid if isLengthKnown() */
+    uint8_t getRemainingLength() const {
+        return (data < end) ? end - data : 0;
+    }
+
 private:
     uint8_t* data;
+    uint8_t* end;
     serialization_type_t type;
 };
 
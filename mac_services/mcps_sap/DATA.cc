@@ -46,9 +46,11 @@
 #include "../../dsmeLayer/messageDispatcher/MessageDispatcher.h"
 #include "../../dsmeLayer/messages/IEEE802154eMACHeader.h"
 #include "../../interfaces/IDSMEMessage.h"
+#include "../../interfaces/IDSMEPlatform.h"
 #include "../dataStructures/DSMEAllocationCounterTable.h"
 #include "../dataStructures/IEEE802154MacAddress.h"
 #include "../pib/MAC_PIB.h"
+#include "../pib/dsme_phy_constants.h"
 
 namespace dsme {
 namespace mcps_sap {
@@ -87,6 +89,13 @@ void DATA::request(request_parameters& params) {
     header.setIEListPresent(false);
     header.setSeqNumSuppression(params.seqNumSuppressed);
 
+    if(params.criticalEventMessage && this->dsme.getMAC_PIB().macPriorityChannelAccess && !header.isCriticalEvent()) {
+        /* '-> prioritized in the queues and confirmed with TRANSACTION_EXPIRED once macCritMsgDelayTol (in ms) has passed
+         *     like any GTS request, it is rejected with INVALID_GTS without a TX GTS, so the next higher layer can resend it in the CAP */
+        uint32_t delayTolerance = this->dsme.getMAC_PIB().macCritMsgDelayTol * 1000 / aSymbolDuration;
+        header.setCriticalEventDeadline(this->dsme.getPlatform().getSymbolCounter() + delayTolerance);
+    }
+
     if(params.gtsTx) {
         // TODO use short address!
         IEEE802154MacAddress& dest = msg->getHeader().getDestAddr();
@@ -115,6 +124,17 @@ void DATA::request(request_parameters& params) {
             confirmParams.gtsTX = params.gtsTx;
             notify_confirm(confirmParams);
         }
+    } else if(params.indirectTx) {
+        /* the destination fetches the frame by a POLL during the CAP */
+        if(!this->dsme.getMessageDispatcher().sendIndirect(msg)) {
+            mcps_sap::DATA_confirm_parameters confirmParams;
+            confirmParams.msduHandle = msg;
+            confirmParams.timestamp = 0;
+            confirmParams.rangingReceived = false;
+            confirmParams.status = DataStatus::TRANSACTION_OVERFLOW;
+            confirmParams.gtsTX = params.gtsTx;
+            notify_confirm(confirmParams);
+        }
     } else {
         if(!this->dsme.getMessageDispatcher().sendInCAP(msg)) {
             mcps_sap::DATA_confirm_parameters confirmParams;
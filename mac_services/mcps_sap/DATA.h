@@ -152,7 +152,7 @@ public:
         bool seqNumSuppressed;
         bool sendMultipurpose;
         NOT_IMPLEMENTED_t frakPolicy;
-        NOT_IMPLEMENTED_t criticalEventMessage;
+        bool criticalEventMessage;
     };
 
     void request(request_parameters&);
@@ -53,6 +53,13 @@ namespace mcps_sap {
 
 MCPS_SAP::MCPS_SAP(DSMELayer& dsme) : dsme(dsme), data(dsme), purge(dsme) {
     this->dsme.setMCPS(this);
+
+#ifdef DSME_THREADED_UPPER_HALF
+    DSMEUpperHalfDispatcher* upperHalf = &(this->dsme.getUpperHalf());
+    this->data.deferIndication(upperHalf);
+    this->data.deferConfirm(upperHalf);
+    this->purge.deferConfirm(upperHalf);
+#endif
 }
 
 DATA& MCPS_SAP::getDATA() {
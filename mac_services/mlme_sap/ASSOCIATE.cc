@@ -74,15 +74,17 @@ void ASSOCIATE::request(request_parameters& params) {
     dsme.getMAC_PIB().macChannelPage = params.channelPage;
     dsme.getMAC_PIB().macNumberOfChannels = dsme.getMAC_PIB().helper.getNumChannels();
 
-    DSMEAssociationRequestCmd associateRequestCmd(params.capabilityInformation, params.hoppingSequenceId, params.channelOffset, params.allocationOrder);
+    DSMEAssociationRequestCmd associateRequestCmd(params.capabilityInformation, params.hoppingSequenceId, params.channelOffset, params.dsmeAssociation,
+                                                  params.direction, dsme.getMAC_PIB().macAssociationGTSAllocation);
     AssociationManager& associationManager = dsme.getAssociationManager();
     associationManager.sendAssociationRequest(associateRequestCmd, params);
 }
 
 void ASSOCIATE::response(response_parameters& params) {
     DSMEAssociationResponseCmd response(params.assocShortAddress, params.status, dsme.getMAC_PIB().macHoppingSequenceLength, params.hoppingSequence,
-                                        params.allocationOrder, params.biIndex, params.superframeId, params.slotId, params.channelIndex,
-                                        this->dsme.getMAC_PIB().macChannelDiversityMode);
+                                        params.allocationOrder, params.biIndex, params.dsmeAssociation, params.superframeId, params.slotId,
+                                        params.channelIndex, this->dsme.getMAC_PIB().macChannelDiversityMode,
+                                        this->dsme.getMAC_PIB().macAssociationGTSAllocation);
     AssociationManager& associationManager = dsme.getAssociationManager();
 
     if(params.status != AssociationStatus::FASTA_SUCCESSFUL) {
@@ -90,7 +92,7 @@ void ASSOCIATE::response(response_parameters& params) {
          * response is added to a list of pending transactions
          */
     }
-    associationManager.sendAssociationReply(response, params.deviceAddress);
+    associationManager.sendAssociationReply(response, params.deviceAddress, params.direction);
 }
 
 } /* namespace mlme_sap */
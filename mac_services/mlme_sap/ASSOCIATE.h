@@ -63,8 +63,8 @@ struct ASSOCIATE_indication_parameters {
     NOT_IMPLEMENTED_t keyIndex;
     uint16_t channelOffset;
     uint8_t hoppingSequenceId;
-    NOT_IMPLEMENTED_t dsmeAssociation;
-    NOT_IMPLEMENTED_t direction;
+    bool dsmeAssociation{false}; // a GTS is requested together with the association
+    Direction direction{TX};     // of the requested GTS as seen from the device
     NOT_IMPLEMENTED_t allocationOrder;
     bool hoppingSequenceRequest;
 };
@@ -78,12 +78,12 @@ struct ASSOCIATE_confirm_parameters {
     NOT_IMPLEMENTED_t keyIndex;
     uint16_t channelOffset;
     uint8_t* hoppingSequence; // TODO
-    NOT_IMPLEMENTED_t dsmeAssociation;
+    bool dsmeAssociation{false}; // a GTS was allocated together with the association
     NOT_IMPLEMENTED_t allocationOrder;
     NOT_IMPLEMENTED_t biIndex;
-    NOT_IMPLEMENTED_t superframeId;
-    NOT_IMPLEMENTED_t slotId;
-    NOT_IMPLEMENTED_t channelIndex;
+    uint16_t superframeId{0};
+    uint8_t slotId{0};
+    uint16_t channelIndex{0};
 };
 
 /*
@@ -106,8 +106,8 @@ public:
         NOT_IMPLEMENTED_t keyIndex;
         uint16_t channelOffset;    // To be ignored, when in channel adaption mode
         uint8_t hoppingSequenceId; // To be ignored, when in channel adaption mode
-        NOT_IMPLEMENTED_t dsmeAssociation;
-        NOT_IMPLEMENTED_t direction;
+        bool dsmeAssociation{false};
+        Direction direction{TX};
         NOT_IMPLEMENTED_t allocationOrder;
         bool hoppingSequenceRequest;
     };
@@ -120,13 +120,14 @@ public:
         NOT_IMPLEMENTED_t keySource;
         NOT_IMPLEMENTED_t keyIndex;
         uint16_t channelOffset;
-        MacStaticList<uint8_t, 30> hoppingSequence; // TODO
-        NOT_IMPLEMENTED_t dsmeAssociation;
+        hoppingSequence_t hoppingSequence;
+        bool dsmeAssociation{false}; // the GTS given below is allocated together with the association
+        Direction direction{TX};     // of the allocated GTS as seen from the device
         NOT_IMPLEMENTED_t allocationOrder;
         NOT_IMPLEMENTED_t biIndex;
-        NOT_IMPLEMENTED_t superframeId;
-        NOT_IMPLEMENTED_t slotId;
-        NOT_IMPLEMENTED_t channelIndex;
+        uint16_t superframeId{0};
+        uint8_t slotId{0};
+        uint16_t channelIndex{0};
         AssociationStatus::Association_Status status;
     };
 
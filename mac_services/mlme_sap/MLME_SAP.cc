@@ -62,6 +62,23 @@ class SYNC_LOSS;
 MLME_SAP::MLME_SAP(DSMELayer& dsme)
     : dsme(dsme), associate(dsme), disassociate(dsme), dsme_gts(dsme), poll(dsme), reset(dsme), scan(dsme), start(dsme), sync(dsme) {
     this->dsme.setMLME(this);
+
+#ifdef DSME_THREADED_UPPER_HALF
+    DSMEUpperHalfDispatcher* upperHalf = &(this->dsme.getUpperHalf());
+    this->associate.deferIndication(upperHalf);
+    this->associate.deferConfirm(upperHalf);
+    this->beacon_notify.deferIndication(upperHalf);
+    this->comm_status.deferIndication(upperHalf);
+    this->disassociate.deferIndication(upperHalf);
+    this->disassociate.deferConfirm(upperHalf);
+    this->dsme_gts.deferIndication(upperHalf);
+    this->dsme_gts.deferConfirm(upperHalf);
+    this->poll.deferConfirm(upperHalf);
+    this->reset.deferConfirm(upperHalf);
+    this->scan.deferConfirm(upperHalf);
+    this->start.deferConfirm(upperHalf);
+    this->sync_loss.deferIndication(upperHalf);
+#endif
 }
 
 ASSOCIATE& MLME_SAP::getASSOCIATE() {
@@ -42,6 +42,7 @@
 
 #include "./POLL.h"
 
+#include "../../../dsme_platform.h"
 #include "../../dsmeLayer/DSMELayer.h"
 #include "../../dsmeLayer/messageDispatcher/MessageDispatcher.h"
 #include "../../dsmeLayer/messages/IEEE802154eMACHeader.h"
@@ -53,10 +54,39 @@
 namespace dsme {
 namespace mlme_sap {
 
-POLL::POLL(DSMELayer& dsme) : dsme(dsme) {
+POLL::POLL(DSMELayer& dsme) : dsme(dsme), state(State::IDLE), macInitiated(false) {
 }
 
 void POLL::request(request_parameters& params) {
+    if(state != State::IDLE) {
+        if(macInitiated && params.coordAddress == coordAddress) {
+            /* '-> the DATA-REQUEST to this coordinator is already on its way, report its result to the next higher layer */
+            macInitiated = false;
+            return;
+        }
+        LOG_INFO("POLL already pending.");
+        POLL_confirm_parameters confirmParams;
+        confirmParams.status = PollStatus::INVALID_PARAMETER;
+        notify_confirm(confirmParams);
+        return;
+    }
+
+    macInitiated = false;
+    sendDataRequest(params);
+}
+
+bool POLL::requestFromMAC(request_parameters& params) {
+    if(state != State::IDLE) {
+        /* '-> the pending POLL already fetches data */
+        return false;
+    }
+
+    macInitiated = true;
+    sendDataRequest(params);
+    return true;
+}
+
+void POLL::sendDataRequest(request_parameters& params) {
     IDSMEMessage* msg = dsme.getPlatform().getEmptyMessage();
 
     /*IEEE802.15.4-2011 5.3.4*/
@@ -82,10 +112,56 @@ void POLL::request(request_parameters& params) {
 
     msg->getHeader().setFrameType(IEEE802154eMACHeader::FrameType::COMMAND);
 
+    coordAddress = params.coordAddress;
+    state = State::WAIT_FOR_ACK;
     if(!dsme.getMessageDispatcher().sendInCAP(msg)) {
-        // TODO ?
         dsme.getPlatform().releaseMessage(msg);
+        finish(PollStatus::CHANNEL_ACCESS_FAILURE);
+    }
+}
+
+void POLL::onCSMASent(DataStatus::Data_Status status) {
+    if(state != State::WAIT_FOR_ACK) {
+        /* '-> the data arrived before the transmission was reported */
+        return;
+    }
+
+    switch(status) {
+        case DataStatus::SUCCESS:
+            state = State::WAIT_FOR_DATA;
+            break;
+        case DataStatus::NO_ACK:
+            finish(PollStatus::NO_ACK);
+            break;
+        default:
+            finish(PollStatus::CHANNEL_ACCESS_FAILURE);
+            break;
+    }
+}
+
+void POLL::handleDataReceived(const IEEE802154MacAddress& srcAddr) {
+    if(state != State::IDLE && srcAddr.getShortAddress() == coordAddress.getShortAddress()) {
+        finish(PollStatus::SUCCESS);
+    }
+}
+
+void POLL::handleStartOfCFP() {
+    if(state == State::WAIT_FOR_DATA) {
+        LOG_INFO("No data received for POLL.");
+        finish(PollStatus::NO_DATA);
+    }
+}
+
+void POLL::finish(PollStatus::Poll_Status status) {
+    state = State::IDLE;
+    if(macInitiated) {
+        /* '-> not requested by the next higher layer, so it is not confirmed */
+        LOG_DEBUG("Automatic POLL finished with status " << (uint16_t)status << ".");
+        return;
     }
+    POLL_confirm_parameters confirmParams;
+    confirmParams.status = status;
+    notify_confirm(confirmParams);
 }
 
 } /* namespace mlme_sap */
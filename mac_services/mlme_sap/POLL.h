@@ -73,8 +73,44 @@ public:
 
     void request(request_parameters&);
 
+    /*
+     * POLL issued by the MAC itself (macAutoRequest), it is not confirmed to the next higher layer
+     * \return false if a POLL is already pending
+     */
+    bool requestFromMAC(request_parameters&);
+
+    /*
+     * Data is only awaited by one POLL at a time
+     */
+    bool isPending() const {
+        return state != State::IDLE;
+    }
+
+    /*
+     * Called when the transmission of the DATA-REQUEST command has finished
+     */
+    void onCSMASent(DataStatus::Data_Status status);
+
+    /*
+     * Called for every indicated data frame, the POLL succeeds once the coordinator delivered its frame
+     */
+    void handleDataReceived(const IEEE802154MacAddress& srcAddr);
+
+    /*
+     * The coordinator answers within the CAP, so the POLL fails with NO_DATA if nothing arrived until the start of the CFP
+     */
+    void handleStartOfCFP();
+
 private:
+    enum class State : uint8_t { IDLE, WAIT_FOR_ACK, WAIT_FOR_DATA };
+
+    void sendDataRequest(request_parameters& params);
+    void finish(PollStatus::Poll_Status status);
+
     DSMELayer& dsme;
+    State state;
+    bool macInitiated;
+    IEEE802154MacAddress coordAddress;
 };
 
 } /* namespace mlme_sap */
@@ -328,10 +328,10 @@ public:
     uint32_t macPhyConfiguration{0};
 
     /** The number of channels in the Hopping Sequence. Does not necessarily equal macNumberOfChannels. */
-    uint8_t macHoppingSequenceLength{0}; // TODO this should be uint16_t
+    uint16_t macHoppingSequenceLength{0};
 
     /** A macHoppingSequenceLengthelement set of channels to be hopped over. */
-    MacStaticList<uint8_t, 30> macHoppingSequenceList; // TODO this should be uint16_t
+    hoppingSequence_t macHoppingSequenceList;
 
     /** For unslotted channel hopping modes, this field is the channel dwell time, in units of 10 µs. For other modes, the field is empty. */
     uint16_t macHopDwellTime{0};
@@ -427,6 +427,18 @@ public:
     /** Indicates whether DSME GTSs are allocated during the association procedure. This attribute is set to TRUE if a device requests assignment of a DSME GTS
      * during association. */
     bool macDsmeAssociation{true};
+
+    /** Not part of the standard. If TRUE, only the first CAP slot is used on the common channel, for broadcasts. In the remaining CAP slots each device
+     * listens on a channel derived from its address and unicast frames are sent on the channel of the receiver. */
+    bool macMultiChannelCAP{false};
+
+    /** Not part of the standard. If TRUE, the PAN coordinator enables or disables the CAP reduction depending on the measured CAP load and announces it
+     * in its beacon, all other devices adopt it from their SYNC parent. macCapReduction reflects the CAP reduction currently in use. */
+    bool macDynamicCapReduction{false};
+
+    /** Not part of the standard. If TRUE, the DSME association request and response carry an additional octet for requesting a DSME GTS and the
+     * response carries the GTS allocated by the coordinator. Changes the format of both commands, so all devices of the PAN have to use the same value. */
+    bool macAssociationGTSAllocation{false};
 };
 
 } /* namespace dsme */
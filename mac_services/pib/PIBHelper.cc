@@ -55,6 +55,28 @@ PIBHelper::PIBHelper(PHY_PIB& phy_pib, MAC_PIB& mac_pib) : phy_pib(phy_pib), mac
     return;
 }
 
+inline const channelList_t* PIBHelper::currentChannels() const {
+    if(cache.channelTuple == nullptr || cache.channelPage != phy_pib.phyCurrentPage || cache.channelTupleIndex >= phy_pib.phyChannelsSupported.getLength() ||
+       phy_pib.phyChannelsSupported[cache.channelTupleIndex] != cache.channelTuple) {
+        cache.channelPage = phy_pib.phyCurrentPage;
+        cache.channelTuple = nullptr;
+        for(uint8_t i = 0; i < phy_pib.phyChannelsSupported.getLength(); i++) {
+            const MacTuple<uint8_t, channelList_t>* tuple = phy_pib.phyChannelsSupported[i];
+            if(tuple != nullptr && tuple->key == phy_pib.phyCurrentPage) {
+                cache.channelTupleIndex = i;
+                cache.channelTuple = tuple;
+                break;
+            }
+        }
+    }
+
+    if(cache.channelTuple == nullptr) {
+        return nullptr;
+    }
+    return &cache.channelTuple->value;
+}
+
+#ifndef DSME_STATIC_CONFIGURATION
 uint8_t PIBHelper::getNumberGTSlotsPerMultisuperframe() const {
     return getNumGTSlots(0) + (getNumberSuperframesPerMultiSuperframe()-1) * getNumGTSlots(1);
 }
@@ -92,24 +114,26 @@ uint32_t PIBHelper::getSymbolsPerSlot() const {
 }
 
 uint8_t PIBHelper::getNumChannels() const {
-    for(uint8_t i = 0; i < phy_pib.phyChannelsSupported.getLength(); i++) {
-        if(phy_pib.phyChannelsSupported[i]->key == phy_pib.phyCurrentPage) {
-            return phy_pib.phyChannelsSupported[i]->value.getLength();
-        }
-    }
-    DSME_ASSERT(false);
-    return 0;
+    const channelList_t* channels = currentChannels();
+    DSME_ASSERT(channels != nullptr);
+    return channels->getLength();
+}
+
+bool PIBHelper::isCapReductionSwitchable() const {
+    const uint8_t numGTSlotsReduced = aNumSuperframeSlots - 1;
+    const uint16_t gtSlotsReduced = getNumGTSlots(0) + (getNumberSuperframesPerMultiSuperframe() - 1) * numGTSlotsReduced;
+    return numGTSlotsReduced <= MAX_GTSLOTS && gtSlotsReduced <= ACT_BITMAP_SIZE && gtSlotsReduced * getNumChannels() <= SAB_OCCUPIED_SIZE;
 }
+#endif
 
 const channelList_t& PIBHelper::getChannels() const {
     static channelList_t emptyList(0);
 
-    for(uint8_t i = 0; i < phy_pib.phyChannelsSupported.getLength(); i++) {
-        if(phy_pib.phyChannelsSupported[i]->key == phy_pib.phyCurrentPage) {
-            return phy_pib.phyChannelsSupported[i]->value;
-        }
+    const channelList_t* channels = currentChannels();
+    if(channels == nullptr) {
+        return emptyList;
     }
-    return emptyList;
+    return *channels;
 }
 
 uint8_t PIBHelper::getSubBlockLengthBytes(uint8_t superframeId) const {
@@ -120,4 +144,25 @@ uint16_t PIBHelper::getAckWaitDuration() const {
     return aUnitBackoffPeriod + aTurnaroundTime + phy_pib.phySHRDuration + 6 * phy_pib.phySymbolsPerOctet + ADDITIONAL_ACK_WAIT_DURATION;
 }// 12 + 20 + 12 + 12
 
+uint16_t PIBHelper::getEnhancedAckWaitDuration() const {
+    /* 4 additional octets for the Time Correction IE */
+    return getAckWaitDuration() + 4 * phy_pib.phySymbolsPerOctet;
+}
+
+void PIBHelper::invalidateChannelCache() {
+    this->cache.channelTuple = nullptr;
+}
+
+void PIBHelper::checkStaticConfiguration() const {
+#ifdef DSME_STATIC_CONFIGURATION
+    DSME_ASSERT(mac_pib.macSuperframeOrder == static_configuration::superframeOrder);
+    DSME_ASSERT(mac_pib.macMultiSuperframeOrder == static_configuration::multiSuperframeOrder);
+    DSME_ASSERT(mac_pib.macBeaconOrder == static_configuration::beaconOrder);
+    DSME_ASSERT(mac_pib.macCapReduction == static_configuration::capReduction);
+
+    const channelList_t* channels = currentChannels();
+    DSME_ASSERT(channels == nullptr || channels->getLength() == static_configuration::numChannels);
+#endif
+}
+
 } /* namespace dsme */
@@ -44,6 +44,7 @@
 #define PIBHELPER_H_
 
 #include "./PHY_PIB.h"
+#include "./dsme_static_configuration.h"
 
 namespace dsme {
 
@@ -55,6 +56,44 @@ public:
     PIBHelper(PHY_PIB&, MAC_PIB&);
 
     /* Access to MAC_PIB variable dependent attributes */
+#ifdef DSME_STATIC_CONFIGURATION
+    /* With a static configuration profile the slot geometry is known at compile time */
+    uint8_t getNumberGTSlotsPerMultisuperframe() const {
+        return static_configuration::gtSlotsPerMultiSuperframe;
+    }
+
+    uint8_t getNumberSuperframesPerMultiSuperframe() const {
+        return static_configuration::superframesPerMultiSuperframe;
+    }
+
+    unsigned getNumberSuperframesPerBeaconInterval() const {
+        return static_configuration::superframesPerBeaconInterval;
+    }
+
+    unsigned getNumberMultiSuperframesPerBeaconInterval() const {
+        return static_configuration::multiSuperframesPerBeaconInterval;
+    }
+
+    uint8_t getFinalCAPSlot(uint8_t superframeId) const {
+        return static_configuration::finalCAPSlot(superframeId);
+    }
+
+    uint32_t getSymbolsPerSlot() const {
+        return static_configuration::symbolsPerSlot;
+    }
+
+    uint8_t getNumGTSlots(uint8_t superframeId) const {
+        return static_configuration::numGTSlots(superframeId);
+    }
+
+    uint8_t getNumChannels() const {
+        return static_configuration::numChannels;
+    }
+
+    bool isCapReductionSwitchable() const {
+        return false;
+    }
+#else
     uint8_t getNumberGTSlotsPerMultisuperframe() const;
 
     uint8_t getNumberSuperframesPerMultiSuperframe() const;
@@ -71,15 +110,47 @@ public:
 
     uint8_t getNumChannels() const;
 
+    /**
+     * Checks if the CAP reduction can be switched at runtime, i.e. if the slot bitmaps can hold the slot structure without the CAPs of the latter superframes
+     */
+    bool isCapReductionSwitchable() const;
+#endif
+
     const channelList_t& getChannels() const;
 
     uint8_t getSubBlockLengthBytes(uint8_t superframeID) const;
 
     uint16_t getAckWaitDuration() const;
 
+    /* for frames that may be acknowledged by an enhanced ACK with a Time Correction IE */
+    uint16_t getEnhancedAckWaitDuration() const;
+
+    /**
+     * Forces a new lookup of the channel list of the current channel page on the next access.
+     * Changes of the current channel page or of the channel page tuples are detected automatically. This only has to be
+     * called if the channel list of a channel page is modified in place.
+     */
+    void invalidateChannelCache();
+
+    /**
+     * Asserts that the PIB matches the static configuration profile, if any (see dsme_static_configuration.h).
+     */
+    void checkStaticConfiguration() const;
+
 private:
+    /* The channel list of the current channel page requires a search through phyChannelsSupported */
+    struct ChannelCache {
+        uint8_t channelPage{0};
+        uint8_t channelTupleIndex{0};
+        const MacTuple<uint8_t, channelList_t>* channelTuple{nullptr};
+    };
+
+    inline const channelList_t* currentChannels() const;
+
     PHY_PIB& phy_pib;
     MAC_PIB& mac_pib;
+
+    mutable ChannelCache cache;
 };
 
 } /* namespace dsme */
@@ -0,0 +1,121 @@
+/*
+ * openDSME
+ *
+ * Implementation of the Deterministic & Synchronous Multi-channel Extension (DSME)
+ * introduced in the IEEE 802.15.4e-2012 standard
+ *
+ * Authors: Florian Meier <florian.meier@tuhh.de>
+ *          Maximilian Koestler <maximilian.koestler@tuhh.de>
+ *          Sandrina Backhauss <sandrina.backhauss@tuhh.de>
+ *
+ * Based on
+ *          DSME Implementation for the INET Framework
+ *          Tobias Luebkert <tobias.luebkert@tuhh.de>
+ *
+ * Copyright (c) 2015, Institute of Telematics, Hamburg University of Technology
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DSME_STATIC_CONFIGURATION_H_
+#define DSME_STATIC_CONFIGURATION_H_
+
+#include "../../../dsme_settings.h"
+#include "./dsme_mac_constants.h"
+
+/**
+ * Optional compile-time configuration profile.
+ *
+ * If the superframe structure of a deployment is fixed at build time, define DSME_STATIC_CONFIGURATION
+ * together with the following macros (e.g. in dsme_settings.h):
+ *   DSME_STATIC_SUPERFRAME_ORDER, DSME_STATIC_MULTISUPERFRAME_ORDER, DSME_STATIC_BEACON_ORDER,
+ *   DSME_STATIC_NUM_CHANNELS and DSME_STATIC_CAP_REDUCTION (0 or 1).
+ * The slot geometry is then folded by the compiler and the slot bitmaps are sized exactly instead of for the worst case.
+ * The corresponding PIB attributes still have to be set to the same values, this is checked by assertions when the
+ * slot bitmaps are initialized (see PIBHelper::checkStaticConfiguration).
+ */
+
+namespace dsme {
+
+namespace static_configuration {
+
+#ifdef DSME_STATIC_CONFIGURATION
+constexpr bool enabled{true};
+
+constexpr uint8_t superframeOrder{DSME_STATIC_SUPERFRAME_ORDER};
+constexpr uint8_t multiSuperframeOrder{DSME_STATIC_MULTISUPERFRAME_ORDER};
+constexpr uint8_t beaconOrder{DSME_STATIC_BEACON_ORDER};
+constexpr uint8_t numChannels{DSME_STATIC_NUM_CHANNELS};
+constexpr bool capReduction{DSME_STATIC_CAP_REDUCTION != 0};
+
+static_assert(superframeOrder <= multiSuperframeOrder && multiSuperframeOrder <= beaconOrder, "SO <= MO <= BO is required");
+static_assert(numChannels > 0, "at least one channel is required");
+
+constexpr uint8_t finalCAPSlot(uint8_t superframeId) {
+    return (!capReduction || superframeId == 0) ? 8 : 0;
+}
+
+constexpr uint8_t numGTSlots(uint8_t superframeId) {
+    return aNumSuperframeSlots - 1 - finalCAPSlot(superframeId);
+}
+
+/* 2^(MO-SO) */
+constexpr uint8_t superframesPerMultiSuperframe{1 << (multiSuperframeOrder - superframeOrder)};
+
+/* 2^(BO-SO) */
+constexpr unsigned superframesPerBeaconInterval{1u << (beaconOrder - superframeOrder)};
+
+/* 2^(BO-MO) */
+constexpr unsigned multiSuperframesPerBeaconInterval{1u << (beaconOrder - multiSuperframeOrder)};
+
+constexpr uint16_t gtSlotsPerMultiSuperframe{numGTSlots(0) + (superframesPerMultiSuperframe - 1) * numGTSlots(1)};
+
+/* aBaseSlotDuration * 2^(SO) */
+constexpr uint32_t symbolsPerSlot{aBaseSlotDuration * (1ul << superframeOrder)};
+
+/* the largest number of GT slots of a single superframe */
+constexpr uint8_t maxGTSlotsPerSuperframe{superframesPerMultiSuperframe > 1 && numGTSlots(1) > numGTSlots(0) ? numGTSlots(1) : numGTSlots(0)};
+#else
+constexpr bool enabled{false};
+#endif
+
+} /* namespace static_configuration */
+
+/* Capacities of the slot bitmaps, exact for a static configuration and worst case otherwise */
+#ifdef DSME_STATIC_CONFIGURATION
+constexpr uint16_t ACT_BITMAP_SIZE{static_configuration::gtSlotsPerMultiSuperframe};
+constexpr uint16_t SAB_OCCUPIED_SIZE{static_configuration::gtSlotsPerMultiSuperframe * static_configuration::numChannels};
+/* sub-blocks are received with a length in bytes, so round up to full bytes */
+constexpr uint16_t SAB_SUBBLOCK_SIZE{((static_configuration::maxGTSlotsPerSuperframe * static_configuration::numChannels * MAX_SAB_UNITS + 7) / 8) * 8};
+#else
+constexpr uint16_t ACT_BITMAP_SIZE{MAX_SUPERFRAMES_PER_MULTI_SUPERFRAME * MAX_GTSLOTS};
+constexpr uint16_t SAB_OCCUPIED_SIZE{MAX_OCCUPIED_SLOTS};
+constexpr uint16_t SAB_SUBBLOCK_SIZE{MAX_GTSLOTS * MAX_CHANNELS * MAX_SAB_UNITS};
+#endif
+
+} /* namespace dsme */
+
+#endif /* DSME_STATIC_CONFIGURATION_H_ */